@@ -98,6 +98,116 @@ echo "===="
 $EXE --help -f model.obj -w 800
 echo ""
 
+echo "============================================================"
+echo " -- TEST 12: Parser threads --"
+echo "===="
+echo "1.|   $EXE -f model.obj --threads 4"
+echo "===="
+$EXE -f model.obj --threads 4
+echo "===="
+echo "2.|   $EXE --threads=0"
+echo "===="
+$EXE --threads=0
+echo ""
+
+echo "============================================================"
+echo " -- TEST 13: Mesh cache disabled --"
+echo "===="
+echo "1.|   $EXE -f model.obj --no-cache"
+echo "===="
+$EXE -f model.obj --no-cache
+echo ""
+
+echo "============================================================"
+echo " -- TEST 14: Vertex cache optimization --"
+echo "===="
+echo "1.|   $EXE -f model.obj --optimize"
+echo "===="
+$EXE -f model.obj --optimize
+echo ""
+
+echo "============================================================"
+echo " -- TEST 15: Packed vertexes --"
+echo "===="
+echo "1.|   $EXE -f model.obj --packed"
+echo "2.|   $EXE -f model.obj --optimize --packed"
+echo "===="
+$EXE -f model.obj --packed
+$EXE -f model.obj --optimize --packed
+echo ""
+
+echo "============================================================"
+echo " -- TEST 16: Compressed object file and stdin --"
+echo "===="
+echo "1.|   $EXE -f model.obj.gz"
+echo "2.|   $EXE -f - < model.obj"
+echo "===="
+$EXE -f model.obj.gz
+$EXE -f - < model.obj
+echo ""
+
+echo "============================================================"
+echo " -- TEST 17: Headless bake --"
+echo "===="
+echo "1.|   $EXE --bake resources/objFiles --threads 4"
+echo "2.|   $EXE --bake=model.obj --optimize --packed --no-cache"
+echo "3.|   $EXE --bake"
+echo "===="
+$EXE --bake resources/objFiles --threads 4
+$EXE --bake=model.obj --optimize --packed --no-cache
+$EXE --bake
+echo ""
+
+echo "============================================================"
+echo " -- TEST 18: Binary STL and PLY files --"
+echo "===="
+echo "1.|   $EXE -f model.stl"
+echo "2.|   $EXE -f model.ply --no-cache"
+echo "===="
+$EXE -f model.stl
+$EXE -f model.ply --no-cache
+echo ""
+
+echo "============================================================"
+echo " -- TEST 19: Load and frame trace (make PROFILE=1) --"
+echo "===="
+echo "1.|   $EXE -f model.obj --no-cache --trace=trace.json"
+echo "2.|   $EXE --bake=model.obj --no-cache --trace trace.json"
+echo "3.|   $EXE -f model.obj --trace"
+echo "===="
+$EXE -f model.obj --no-cache --trace=trace.json
+$EXE --bake=model.obj --no-cache --trace trace.json
+$EXE -f model.obj --trace
+echo ""
+
+echo "============================================================"
+echo " -- TEST 20: Offscreen render benchmark --"
+echo "===="
+echo "1.|   $EXE -f model.obj --bench-frames 300"
+echo "2.|   env -u DISPLAY $EXE -f model.obj --bench-frames=100 -w 640 -h 480"
+echo "3.|   $EXE -f model.obj --bench-frames 0"
+echo "===="
+$EXE -f model.obj --bench-frames 300
+env -u DISPLAY $EXE -f model.obj --bench-frames=100 -w 640 -h 480
+$EXE -f model.obj --bench-frames 0
+echo ""
+
+echo "============================================================"
+echo " -- TEST 21: Camera path recording and replay --"
+echo "===="
+echo "1.|   $EXE -f model.obj --record path.txt"
+echo "2.|   $EXE -f model.obj --replay=path.txt"
+echo "3.|   $EXE -f model.obj --replay path.txt --bench-frames 300"
+echo "4.|   $EXE -f model.obj --record path.txt --replay path.txt"
+echo "5.|   $EXE -f model.obj --replay"
+echo "===="
+$EXE -f model.obj --record path.txt
+$EXE -f model.obj --replay=path.txt
+$EXE -f model.obj --replay path.txt --bench-frames 300
+$EXE -f model.obj --record path.txt --replay path.txt
+$EXE -f model.obj --replay
+echo ""
+
 echo "============================================================"
 echo " -- ALL TESTS COMPLETED --"
 echo "============================================================"
@@ -10,14 +10,29 @@
 
 constexpr const char* HOW_TO = R"(Usage: ./scop [options]
 Program that renders an obj file (see for reference: https://en.wikipedia.org/wiki/Wavefront_.obj_file)
-Directives supported: v, vt, vn, f. Materials and lights not implemented yet.
+Directives supported: v, vt, vn, f, mtllib, usemtl (materials: Ka, Kd, Ks, Ns, map_Kd). Lights not implemented yet.
 
-	-f,  --file             object file (e.g. generated from Blender) to render
+	-f,  --file             object file (e.g. generated from Blender) to render, can be gzip/zstd compressed, - reads stdin;
+	                        binary STL and PLY files are read too
 	-w,  --width            width in pixel of the window
 	-h,  --height           height in pixel of the window
 	-vs, --vertexShader     file for vertex shader
 	-ts, --textureShader     file for fragment shader
 	-t,  --texture          texture file to apply to the object
+	     --threads          number of threads used to parse the object file
+	     --no-cache         always parse the object file, don't read or write its mesh cache
+	     --optimize         reorder triangles and vertexes for the GPU vertex cache
+	     --packed           pack the vertexes: half float uvs, 10_10_10_2 normals, RGBA8 colors
+	     --bake             no window: writes the mesh cache of every obj/stl/ply file of a folder (or of one file),
+	                        --threads files at once, with --optimize/--packed; --no-cache rebakes the ones up to date
+	     --bench-frames     renders the number of frames given offscreen (hidden window, works without a display)
+	                        along a scripted path (or the --replay one), then prints the frame times, draw calls
+	                        and triangles per second
+	     --record           writes the camera and model of every frame to a file when the window is closed
+	     --replay           draws the frames of a --record file instead of following the keyboard and mouse,
+	                        one every 1/60s of the recording, then closes the window
+	     --trace            writes the time spent in the loading steps and in the frames to a chrome trace file
+	                        (open it in ui.perfetto.dev), needs a build with: make PROFILE=1
 	     --help             print info
 
 	[options can be set with next word or = : --opt value  | --opt=value ]
@@ -30,6 +45,15 @@ struct InputData {
 	std::string vertexShaderFile = SCOP_VERTEX_SHADER;
 	std::string fragmentShaderFile = SCOP_FRAGMENT_SHADER;
 	std::string textureFile = SCOP_TEXTURE_CAPYBARA;
+	uint32_t	threads = SCOP_PARSE_THREADS;
+	bool		useCache = SCOP_USE_MESH_CACHE;
+	bool		optimize = SCOP_OPTIMIZE_MESH;
+	bool		packed = SCOP_PACK_VERTEXES;
+	std::string	bakePath;
+	std::string	traceFile;
+	uint32_t	benchFrames = 0U;
+	std::string	recordFile;
+	std::string	replayFile;
 	bool		helpmode = false;
 
     static InputData    parseArgs( int32_t, char** ) ;
@@ -39,6 +63,15 @@ struct InputData {
 	static void         setVertexShaderOpt( InputData&, std::optional<std::string> );
 	static void         setFragmentShaderOpt( InputData&, std::optional<std::string> );
 	static void         setTextureFile( InputData&, std::optional<std::string> );
+	static void         setThreads( InputData&, std::optional<std::string> );
+	static void         setNoCache( InputData&, std::optional<std::string> );
+	static void         setOptimize( InputData&, std::optional<std::string> );
+	static void         setPacked( InputData&, std::optional<std::string> );
+	static void         setBakePath( InputData&, std::optional<std::string> );
+	static void         setTraceFile( InputData&, std::optional<std::string> );
+	static void         setBenchFrames( InputData&, std::optional<std::string> );
+	static void         setRecordFile( InputData&, std::optional<std::string> );
+	static void         setReplayFile( InputData&, std::optional<std::string> );
 	static void         setHelpMode( InputData&, std::optional<std::string> );
 };
 
@@ -49,6 +82,15 @@ enum class OptionType {
     VertexShaderFile,
     TextureShaderFile,
     TextureFile,
+    Threads,
+    NoCache,
+    Optimize,
+    Packed,
+    Bake,
+    Trace,
+    BenchFrames,
+    Record,
+    Replay,
     Helpmode
 };
 
@@ -65,6 +107,15 @@ const std::map<std::string, OptionType> flagMap = {
 	{"--textureShader", OptionType::TextureShaderFile},
 	{"-t", OptionType::TextureFile},
 	{"--texture", OptionType::TextureFile},
+	{"--threads", OptionType::Threads},
+	{"--no-cache", OptionType::NoCache},
+	{"--optimize", OptionType::Optimize},
+	{"--packed", OptionType::Packed},
+	{"--bake", OptionType::Bake},
+	{"--trace", OptionType::Trace},
+	{"--bench-frames", OptionType::BenchFrames},
+	{"--record", OptionType::Record},
+	{"--replay", OptionType::Replay},
 	{"--help", OptionType::Helpmode}
 };
 
@@ -75,5 +126,14 @@ const std::map<OptionType, std::function<void( InputData&, std::optional<std::st
 	{OptionType::VertexShaderFile, InputData::setVertexShaderOpt},
 	{OptionType::TextureShaderFile, InputData::setFragmentShaderOpt},
 	{OptionType::TextureFile, InputData::setTextureFile},
+	{OptionType::Threads, InputData::setThreads},
+	{OptionType::NoCache, InputData::setNoCache},
+	{OptionType::Optimize, InputData::setOptimize},
+	{OptionType::Packed, InputData::setPacked},
+	{OptionType::Bake, InputData::setBakePath},
+	{OptionType::Trace, InputData::setTraceFile},
+	{OptionType::BenchFrames, InputData::setBenchFrames},
+	{OptionType::Record, InputData::setRecordFile},
+	{OptionType::Replay, InputData::setReplayFile},
 	{OptionType::Helpmode, InputData::setHelpMode},
 };
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "math/vector.hpp"
+
+
+// what CameraGL needs to rebuild its view matrix
+struct CameraState {
+	VectF3	position;
+	VectF3	forward;
+	VectF3	up;
+};
+
+// what is drawn in a frame: view, model matrix (in Matrix4::data() order) and texture blending
+struct PathFrame {
+	double					time = 0.0;		// seconds since the first frame
+	CameraState				camera;
+	std::array<float,16>	model{};
+	float					blending = 0.0f;
+};
+
+// frames of a session recorded with --record, read back by --replay; text file, one frame per line:
+// time, camera position, forward and up, model matrix, blending level.
+// numbers are written with the shortest text that reads back the same float: a replay draws the recorded frames
+class CameraPath {
+	public:
+		CameraPath( void ) = default;
+		~CameraPath( void ) = default;
+
+		// frames in order of time
+		void				push( PathFrame const& );
+		// last frame at or before the time given, past the end the path starts again
+		PathFrame const&	at( double ) const;
+		size_t				size( void ) const noexcept;
+		double				getDuration( void ) const noexcept;
+
+		void				save( std::string const& ) const;
+		static CameraPath	load( std::string const& );
+
+	private:
+		std::vector<PathFrame>	_frames;
+};
@@ -1,55 +1,66 @@
 #pragma once
 #include <memory>
+#include <array>
 #include <iostream>
 #include <vector>
+#include <utility>
 #include <list>
 #include <cstdint>
 #include <cstddef>
 #include <filesystem>
 
 #include "parser.hpp"
+#include "threadPool.hpp"
+#include "mappedFile.hpp"
+#include "material.hpp"
 #include "math/vector.hpp"
 
 
-struct VBO {
-	uint32_t					size;
-	uint32_t					stride;
-	std::unique_ptr<float[]>	data;
+enum VertexFormat : uint8_t {
+	VERTEX_FLOAT,	// vertex, texture, normal, color as floats: VBO_STRIDE
+	VERTEX_PACKED	// float vertex, half float texture, 10_10_10_2 normal, RGBA8 color: VBO_PACKED_STRIDE
+};
 
-	float const* getData( void ) const;
+// loaded from the mesh cache data is empty, the buffer is read from the mapped file at offset
+struct VBO {
+	uint32_t						size;
+	uint32_t						stride;
+	VertexFormat					format = VERTEX_FLOAT;
+	std::unique_ptr<std::byte[]>	data;
+	std::shared_ptr<MappedFile>		mapping;
+	size_t							offset = 0U;
+	std::array<VectF3,2>			bounds{};	// min and max corner of the positions
+
+	std::byte const*	getData( void ) const;
+	// positions are the first 3 floats of every vertex in both formats
+	void				computeBounds( void );
 };
 
+// indexes are uint32_t while the buffers are built, uint16_t (stride 2) once compacted if the VBO allows it,
+// the triangles of a material are contiguous: one range per material, ranges with the same texture are adjacent
 struct EBO {
-	uint32_t					size;
-	uint32_t					stride;
-	FaceType					type;
-	std::unique_ptr<uint32_t[]>	data;
-
-	uint32_t const*	getData( void ) const;
+	uint32_t						size;
+	uint32_t						stride;
+	FaceType						type;
+	std::vector<DrawRange>			ranges;
+	std::unique_ptr<std::byte[]>	data;
+	std::shared_ptr<MappedFile>		mapping;
+	size_t							offset = 0U;
+
+	std::byte const*	getData( void ) const;
+	uint32_t			getIndex( size_t ) const;
 };
 
 // 44 bytes in total: (3floats vertex + 3floats color + 2floats texture + 3floats normal) * 4bytes
 static constexpr uint32_t VBO_STRIDE = sizeof(VectF3) /*vertex*/ + sizeof(VectF3) /*color*/ + sizeof(VectF2) /*texture*/ + sizeof(VectF3) /*normal*/;
 // 32 bytes: the RGB is not stored
 static constexpr uint32_t VERTEX_STRIDE = VBO_STRIDE - sizeof(VectF3);
+// 24 bytes: 3floats vertex + 2halfs texture + 10_10_10_2 normal + RGBA8 color
+static constexpr uint32_t VBO_PACKED_STRIDE = sizeof(VectF3) /*vertex*/ + 2 * sizeof(uint16_t) /*texture*/ + sizeof(uint32_t) /*normal*/ + sizeof(uint32_t) /*color*/;
 static constexpr uint32_t EBO_STRIDE = sizeof(uint32_t);
+static constexpr uint32_t EBO_SHORT_STRIDE = sizeof(uint16_t);
 using SerializedVertex = std::array<std::byte,VERTEX_STRIDE>;
 
-struct VectorByteHash {
-	uint32_t operator()(SerializedVertex const& arr) const noexcept {
-		uint32_t h = 0U, magicNo = 0x9e3779b9;
-		for (auto b : arr)
-			h ^= std::to_integer<uint32_t>(b) + magicNo + (h << 6) + (h >> 2);
-		return h;
-	}
-};
-
-struct VectorByteEqual {
-	bool operator()(SerializedVertex const& a, SerializedVertex const& b) const noexcept {
-		return a == b;
-	}
-};
-
 namespace fs = std::filesystem;
 
 class ParsedData {
@@ -61,37 +72,51 @@ class ParsedData {
 		std::vector<VectF2> const&		getTextures( void ) const noexcept;
 		std::vector<VectF3> const&		getVerticesNorm( void ) const noexcept;
 		std::vector<VectF3> const&		getParamSpaceVertices( void ) const noexcept;
-		std::list<Face> const&	 		getFaces( void ) const noexcept;
+		FaceStore const&	 			getFaces( void ) const noexcept;
 		std::list<Line> const&	 		getLines( void ) const noexcept;
+		std::vector<Material> const&	getMaterials( void ) const noexcept;
 		std::shared_ptr<VBO> const&		getVBO( void ) const;
 		std::shared_ptr<EBO> const&		getEBO( void ) const;
 		bool							hasFaces( void ) const noexcept;
 
 		// reference: https://www.geometrictools.com/Documentation/TriangulationByEarClipping.pdf
 		void	triangolate( void );
+		void	triangolate( ThreadPool& );
 		void	fixTrianglesOrientation( void );
+		void	fixTrianglesOrientation( ThreadPool& );
 		void	fillTexturesAndNormals( void );
+		void	fillTexturesAndNormals( ThreadPool& );
+		// materials of the mtllib files, a library that can't be read is skipped
+		void	loadMaterials( void );
+		// the EBO is sorted by material, see EBO::ranges
 		void	fillBuffers( void );
+		// optional: triangles reordered for the GPU vertex cache, then vertexes in order of first use,
+		// returns the ACMR before and after
+		std::pair<float,float>	optimizeBuffers( void );
+		// last step: 16 bits indexes if there are less than 65536 vertexes, optionally packed vertexes, bounds of the VBO
+		void	compactBuffers( bool );
 		void	fillVBOnoFaces( void );
 		
 		friend class FileParser;
+		friend class StlReader;
+		friend class PlyReader;
 
 	private:
 		ParsedData( void ) = default;
 
-		std::vector<VectUI3>					_spawnTriangle( std::list<std::pair<VectUI3,VectF2>>&, std::list<VectF2>&, std::list<VectF2>&, std::list<VectF2>& ) const noexcept;
-		std::list<std::pair<VectUI3,VectF2>>	_create2Dvertexes( std::vector<VectUI3> const& ) const noexcept;
-		bool									_isConvex( std::list<std::pair<VectUI3,VectF2>>::const_iterator const&, std::list<std::pair<VectUI3,VectF2>> const& ) const noexcept;
-		bool									_isEar( std::list<std::pair<VectUI3,VectF2>>::const_iterator const&, std::list<std::pair<VectUI3,VectF2>> const& ) const noexcept;
-		SerializedVertex						_serializeVertex( VectUI3 const&, FaceType ) const;
+		void				_projectPolygon( VectUI3 const*, uint32_t, std::vector<VectF2>& ) const noexcept;
+		void				_weightCornerNormals( VectUI3 const*, VectF3* ) const noexcept;
+		std::vector<size_t>	_sortFacesByMaterial( std::vector<DrawRange>& ) const;
+		SerializedVertex	_serializeVertex( VectUI3 const&, FaceType ) const;
 
 		std::vector<fs::path>	_tmlFiles;
 		std::vector<VectF3> 	_vertexes;
 		std::vector<VectF2> 	_textures;
 		std::vector<VectF3> 	_normals;
 		std::vector<VectF3> 	_paramSpaceVertices;
-		std::list<Face>			_faces;
+		FaceStore				_faces;
 		std::list<Line> 		_lines;
+		std::vector<Material>	_materials{Material{}};
 		std::shared_ptr<VBO>	_VBOdata;
 		std::shared_ptr<EBO>	_EBOdata;
 		bool					_triangolationDone = false;
@@ -1,12 +1,55 @@
 #pragma once
 #include<string>
 #include<cstdint>
+#include<cstddef>
 
 constexpr char const* SCOP_OBJECT_FILE = "resources/objFiles/cube.obj";
 
 constexpr uint32_t SCOP_WINDOW_WIDTH = 1920;
 constexpr uint32_t SCOP_WINDOW_HEIGHT = 1080;
 
+constexpr uint32_t SCOP_PARSE_THREADS = 1;
+// smallest piece of file given to a parser thread, below it threads cost more than they save
+constexpr size_t SCOP_PARSE_MIN_CHUNK = 1 << 18;
+// compressed object files (and stdin) are decompressed in two buffers of this size while the other one is parsed
+constexpr size_t SCOP_INPUT_BUFFER_SIZE = 1 << 23;
+// smallest range of faces triangulated (or given uvs and normals) by one thread
+constexpr size_t SCOP_PARALLEL_MIN_FACES = 1 << 10;
+// steps per unit of the generated normal of a face out of the smoothing groups: faces whose normals round
+// to the same steps share their vertexes
+constexpr float SCOP_FLAT_NORMAL_STEPS = 4096.0f;
+
+// entries of the post-transform cache simulated to measure the vertex reuse
+constexpr uint32_t SCOP_VERTEX_CACHE_SIZE = 32;
+constexpr bool SCOP_OPTIMIZE_MESH = false;
+// half float uvs, 10_10_10_2 normals and RGBA8 colors: 24 bytes per vertex instead of 44
+constexpr bool SCOP_PACK_VERTEXES = false;
+
+// the mesh reaches the GPU in chunks while the window is already running: a preview of every block of the file
+// as soon as it's parsed, then the final mesh
+constexpr size_t SCOP_PARSE_PROGRESS_BLOCK = 1 << 24;
+constexpr uint32_t SCOP_STREAM_CHUNK_TRIANGLES = 1 << 15;
+// milliseconds of a frame spent uploading chunks, at least one chunk is uploaded per frame
+constexpr double SCOP_STREAM_FRAME_BUDGET_MS = 4.0;
+constexpr size_t SCOP_STREAM_QUEUE_SIZE = 64;
+
+// --bench-frames: frames rendered before the timed ones, turns of the model around its vertical axis during the timed ones
+constexpr uint32_t SCOP_BENCH_WARMUP_FRAMES = 10;
+constexpr float SCOP_BENCH_TURNS = 2.0f;
+
+// --record/--replay: first line of a camera path file, step between the replayed frames (seconds of the recording)
+constexpr char const* SCOP_CAMERA_PATH_HEADER = "# scop camera path 1";
+constexpr double SCOP_REPLAY_TIMESTEP = 1.0 / 60.0;
+
+// zones kept per thread by the profiler (make PROFILE=1), about an hour of frames
+constexpr size_t SCOP_TRACE_MAX_EVENTS = 1 << 20;
+
+// binary VBO/EBO of an object file, stored next to it
+constexpr char const* SCOP_MESH_CACHE_EXTENSION = ".scopmesh";
+constexpr char const* SCOP_MESH_CACHE_MAGIC = "SCOPMESH";
+constexpr uint32_t SCOP_MESH_CACHE_VERSION = 8;
+constexpr bool SCOP_USE_MESH_CACHE = true;
+
 constexpr char const* SCOP_VERTEX_SHADER = "resources/shaders/vertexShader.glsl";
 constexpr char const* SCOP_FRAGMENT_SHADER = "resources/shaders/fragmentShader.glsl";
 constexpr char const* SCOP_TEXTURE_CAPYBARA = "resources/textures/capybara.jpg";
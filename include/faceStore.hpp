@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+#include "math/vector.hpp"
+
+
+enum FaceType : uint8_t {
+	VERTEX,
+	VERTEX_TEXT,
+	VERTEX_VNORM,
+	VERTEX_TEXT_VNORM
+};
+
+std::string	faceToString( FaceType );
+
+// every name (object, group, material) is stored once and referenced by its id, id 0 is the empty name
+class StringTable {
+	public:
+		StringTable( void ) : _names{""}, _ids{{"", 0U}} {};
+		~StringTable( void ) = default;
+
+		uint32_t			intern( std::string_view );
+		std::string const&	getName( uint32_t ) const noexcept;
+		size_t				size( void ) const noexcept;
+
+	private:
+		std::vector<std::string>					_names;
+		std::unordered_map<std::string,uint32_t>	_ids;
+};
+
+// object, group and material are ids of the StringTable of the store, smoothing is the group number
+struct FaceAttributes {
+	uint32_t	object = 0U;
+	uint32_t	group = 0U;
+	uint32_t	material = 0U;
+	uint32_t	smoothing = 0U;
+};
+
+class FaceStore;
+
+// read-only view of a face inside a FaceStore
+class Face {
+	public:
+		Face( FaceStore const& store, size_t index ) noexcept : _store(store), _index(index) {};
+		~Face( void ) = default;
+
+		FaceType 			getFaceType( void ) const noexcept;
+		uint32_t			size( void ) const noexcept;
+		VectUI3 const*		begin( void ) const noexcept;
+		VectUI3 const*		end( void ) const noexcept;
+		std::string const&	getObject( void ) const noexcept;
+		std::string const&	getGroup( void ) const noexcept;
+		std::string const&	getMaterial( void ) const noexcept;
+		uint32_t 			getSmoothing( void ) const noexcept;
+
+	private:
+		FaceStore const&	_store;
+		size_t				_index;
+};
+
+// faces stored as struct of arrays: the corners of every face are in one flat array,
+// face i owns the corners [offsets[i], offsets[i + 1]) and its attributes are interned ids
+class FaceStore {
+	public:
+		FaceStore( void ) : _offsets{0U} {};
+		~FaceStore( void ) = default;
+
+		void	reserve( size_t, size_t );
+		// n faces of the same number of corners, filled later with set(): ranges can be written in parallel
+		void	resize( size_t, uint32_t );
+		void	push( FaceType, VectUI3 const*, uint32_t, FaceAttributes const& );
+		void	set( size_t, FaceType, VectUI3 const*, FaceAttributes const& ) noexcept;
+		void	append( FaceStore const& );
+
+		size_t						size( void ) const noexcept;
+		bool						empty( void ) const noexcept;
+		Face						operator[]( size_t ) const noexcept;
+		FaceType					getFaceType( size_t ) const noexcept;
+		void						setFaceType( size_t, FaceType ) noexcept;
+		uint32_t					getCornersCount( size_t ) const noexcept;
+		size_t						getFirstCorner( size_t ) const noexcept;
+		VectUI3 const*				getCorners( size_t ) const noexcept;
+		VectUI3*					getCorners( size_t ) noexcept;
+		std::vector<VectUI3> const&	getAllCorners( void ) const noexcept;
+		FaceAttributes				getAttributes( size_t ) const noexcept;
+		void						setAttributes( size_t, FaceAttributes const& ) noexcept;
+		StringTable const&			getNames( void ) const noexcept;
+		StringTable&				getNames( void ) noexcept;
+
+	private:
+		std::vector<VectUI3>	_corners;
+		std::vector<uint32_t>	_offsets;
+		std::vector<FaceType>	_types;
+		std::vector<uint32_t>	_objects;
+		std::vector<uint32_t>	_groups;
+		std::vector<uint32_t>	_materials;
+		std::vector<uint32_t>	_smoothings;
+		StringTable				_names;
+};
+
+std::ostream& operator<<( std::ostream&, FaceType );
+std::ostream& operator<<( std::ostream&, Face const& );
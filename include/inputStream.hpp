@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+
+#include "define.hpp"
+
+struct z_stream_s;
+struct ZSTD_DCtx_s;
+
+
+// compression of an input, found from its first bytes (the extension doesn't matter)
+enum class Compression {
+	NONE,
+	GZIP,
+	ZSTD
+};
+
+// compression of a file, NONE if it can't be read: the caller opening it reports the error
+Compression	detectCompression( std::string const& );
+
+// bytes of a file ("-" for stdin) decompressed while they are read, a small input buffer is reused:
+// the memory used doesn't depend on the size of the file
+class InputStream {
+	public:
+		explicit InputStream( std::string const& );
+		InputStream( InputStream const& ) = delete;
+		InputStream& operator=( InputStream const& ) = delete;
+		~InputStream( void ) noexcept;
+
+		// fills buffer with up to size decompressed bytes, returns how many, 0 at the end of the input
+		size_t		read( char*, size_t );
+		Compression	getCompression( void ) const noexcept;
+		uint64_t	getReadBytes( void ) const noexcept;	// bytes read from the file, compressed
+
+	private:
+		std::string					_fileName;
+		int							_fd = -1;
+		Compression					_compression = Compression::NONE;
+		std::vector<char>			_input;
+		size_t						_inputStart = 0U;
+		size_t						_inputEnd = 0U;
+		bool						_endOfFile = false;
+		bool						_endOfStream = false;
+		uint64_t					_readBytes = 0U;
+		std::unique_ptr<z_stream_s>	_gzip;
+		ZSTD_DCtx_s*				_zstd = nullptr;
+		bool						_frameDone = true;	// the last zstd frame read was complete
+
+		bool	_fillInput( void );
+		size_t	_readPlain( char*, size_t );
+		size_t	_readGzip( char*, size_t );
+		size_t	_readZstd( char*, size_t );
+};
+
+// decompression on its own thread in two buffers: the parser reads one while the other is filled
+class StreamPipeline {
+	public:
+		explicit StreamPipeline( std::string const&, size_t = SCOP_INPUT_BUFFER_SIZE );
+		StreamPipeline( StreamPipeline const& ) = delete;
+		StreamPipeline& operator=( StreamPipeline const& ) = delete;
+		~StreamPipeline( void ) noexcept;
+
+		// next block of the input, valid until the next call, empty at the end (errors of the reader are rethrown here)
+		std::string_view	next( void );
+		Compression			getCompression( void ) const noexcept;
+		uint64_t			getReadBytes( void ) const noexcept;
+
+	private:
+		InputStream							_stream;
+		size_t								_bufferSize;
+		std::array<std::unique_ptr<char[]>,2>	_buffers;	// not zeroed: small inputs touch only a few pages
+		std::array<size_t,2>				_sizes{0U, 0U};
+		std::array<bool,2>					_full{false, false};
+		size_t								_current = 0U;
+		bool								_holding = false;	// the parser is reading _buffers[_current]
+		bool								_done = false;
+		bool								_stop = false;
+		std::exception_ptr					_error;
+		std::mutex							_mutex;
+		std::condition_variable				_changed;
+		std::thread							_reader;
+
+		void	_readInput( void ) noexcept;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+
+// directive of a line, found from its first word: the parser jumps to the right reader without comparing strings
+enum ObjDirective : uint8_t {
+	DIRECTIVE_VERTEX,			// v
+	DIRECTIVE_TEXTURE,			// vt
+	DIRECTIVE_NORMAL,			// vn
+	DIRECTIVE_SPACE_VERTEX,		// vp
+	DIRECTIVE_FACE,				// f
+	DIRECTIVE_LINE,				// l
+	DIRECTIVE_OBJECT,			// o
+	DIRECTIVE_GROUP,			// g
+	DIRECTIVE_SMOOTHING,		// s
+	DIRECTIVE_USEMTL,			// usemtl
+	DIRECTIVE_MTLLIB,			// mtllib
+	DIRECTIVE_COMMENT,			// #
+	DIRECTIVE_EMPTY,			// nothing, or just blanks
+	DIRECTIVE_OTHER				// anything else (leading blanks, unknown word), read by the generic path
+};
+
+// line of the buffer without its '\n', content starts after the directive word and its blank
+struct ObjLine {
+	std::string_view	line;
+	std::string_view	content;
+	ObjDirective		directive;
+};
+
+// instruction set used to find the newlines, the best one supported by the cpu is picked at runtime
+enum ScanLevel : uint8_t {
+	SCAN_SCALAR,
+	SCAN_SSE2,
+	SCAN_AVX2
+};
+
+// first stage of the parser, like simdjson: the newlines of every 64 bytes block are found at once as a bit mask,
+// then the lines are classified in batches the second stage (the number parsing) walks without looking for the ends
+class LineScanner {
+	public:
+		static constexpr size_t BATCH_SIZE = 1024;
+
+		explicit LineScanner( std::string_view, ScanLevel = LineScanner::detectLevel() ) noexcept;
+		~LineScanner( void ) = default;
+
+		// fills the batch with the next lines, returns how many, 0 at the end of the buffer
+		size_t	next( std::array<ObjLine,BATCH_SIZE>& ) noexcept;
+
+		static ScanLevel	detectLevel( void ) noexcept;
+		static char const*	levelToString( ScanLevel ) noexcept;
+
+	private:
+		using MaskFunction = uint64_t (*)( char const* ) noexcept;
+
+		std::string_view	_buffer;
+		MaskFunction		_newlineMask;
+		size_t				_nextBlock = 0U;
+		size_t				_maskBase = 0U;		// block whose newlines are in _mask
+		uint64_t			_mask = 0U;			// newlines of the block not returned yet
+		size_t				_lineStart = 0U;
+
+		void	_loadBlock( void ) noexcept;
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+
+// read-only view of a whole file mapped in memory, unmapped when destroyed
+class MappedFile {
+	public:
+		explicit MappedFile( std::string const& );
+		MappedFile( MappedFile const& ) = delete;
+		MappedFile& operator=( MappedFile const& ) = delete;
+		~MappedFile( void ) noexcept;
+
+		char const*			data( void ) const noexcept;
+		size_t				size( void ) const noexcept;
+		std::string_view	view( void ) const noexcept;
+
+	private:
+		char const*	_data = nullptr;
+		size_t		_size = 0U;
+};
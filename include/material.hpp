@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <filesystem>
+
+#include "math/vector.hpp"
+
+
+namespace fs = std::filesystem;
+
+// colors of a material of a .mtl file, the material 0 of a mesh is the default one
+// used by the faces without usemtl (or with a material not found in the libraries)
+struct Material {
+	std::string	name;
+	VectF3		ambient{0.2f, 0.2f, 0.2f};	// Ka
+	VectF3		diffuse{0.8f, 0.8f, 0.8f};	// Kd
+	VectF3		specular{0.0f, 0.0f, 0.0f};	// Ks
+	float		shininess = 0.0f;			// Ns
+	fs::path	diffuseMap;					// map_Kd, empty if the material has no texture
+};
+
+// indexes [first, first + count) of the EBO drawn with the same material
+struct DrawRange {
+	uint32_t	material;
+	uint32_t	first;
+	uint32_t	count;
+};
+
+// reads the material libraries of an object file, only Ka, Kd, Ks, Ns and map_Kd are used
+// reference: https://paulbourke.net/dataformats/mtl/
+class MaterialParser {
+	public:
+		MaterialParser( void ) = default;
+		~MaterialParser( void ) = default;
+
+		// appends the materials of the file, textures are relative to the folder of the file
+		void	parse( fs::path const&, std::vector<Material>& ) const;
+
+	private:
+		// firstMaterial: size of the materials when the file started, they aren't of this file
+		void				_parseDirective( std::string_view, fs::path const&, std::vector<Material>&, size_t ) const;
+		VectF3				_createColor( std::string_view ) const;
+		fs::path			_createMap( std::string_view, fs::path const& ) const;
+};
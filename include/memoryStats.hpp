@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+
+// heap use of the whole program: operator new is replaced to count every allocation
+// (not with DEBUG=1: the address sanitizer needs its own operator new)
+struct MemoryStats {
+	uint64_t	allocations;
+	uint64_t	allocatedBytes;		// total asked, frees aren't subtracted
+	uint64_t	peakRss;			// bytes, highest resident set size so far
+};
+
+MemoryStats	getMemoryStats( void ) noexcept;
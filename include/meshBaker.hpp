@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <filesystem>
+
+#include "threadPool.hpp"
+
+
+namespace fs = std::filesystem;
+
+// result of one object file, bytes are the obj text parsed (decompressed if the file is compressed)
+struct BakeResult {
+	fs::path	file;
+	bool		baked = false;
+	bool		upToDate = false;
+	uint64_t	bytes = 0U;
+	double		milliseconds = 0.0;
+	uint32_t	vertexes = 0U;
+	uint32_t	indexes = 0U;
+	std::string	error;
+};
+
+// headless preprocessing: the mesh cache of every object file (.obj, .obj.gz, .obj.zst, .stl, .ply) of a folder is written
+// without a window, the files are baked in parallel and each one is parsed by a single thread
+class MeshBaker {
+	public:
+		// flags: MeshCacheFlags of the caches written, force: bake also the files whose cache is up to date
+		MeshBaker( uint32_t, uint32_t, bool );
+		~MeshBaker( void ) = default;
+
+		// a folder is searched recursively, a file is baked alone; prints a line per file and a summary,
+		// returns false if a file failed
+		bool	bake( fs::path const& );
+
+	private:
+		std::vector<fs::path>	_findObjectFiles( fs::path const& ) const;
+		BakeResult				_bakeFile( fs::path const& ) const;
+		void					_printResult( BakeResult const& );
+
+		ThreadPool	_pool;
+		uint32_t	_flags;
+		bool		_force;
+		std::mutex	_printMutex;	// lines of the files finishing at the same time aren't mixed
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <filesystem>
+
+#include "data.hpp"
+#include "material.hpp"
+
+
+namespace fs = std::filesystem;
+
+// header of the cache file, followed by the source path, then (8 bytes aligned) the VBO and the EBO,
+// then (8 bytes aligned) the draw ranges of the EBO and the materials block
+struct MeshCacheHeader {
+	std::array<char,8>	magic;
+	uint32_t			version;
+	uint32_t			pathSize;
+	uint64_t			sourceSize;
+	int64_t				sourceMtime;	// nanoseconds
+	uint64_t			sourceHash;		// FNV-1a of the whole source file
+	uint32_t			vboSize;
+	uint32_t			vboStride;
+	uint32_t			eboSize;		// 0 if the object has no faces
+	uint32_t			eboStride;
+	uint32_t			eboType;
+	uint32_t			flags;			// MeshCacheFlags the buffers were built with
+	uint32_t			rangesCount;
+	uint32_t			materialsSize;	// bytes: the material libraries with their size and mtime, then the materials
+	std::array<VectF3,2>	bounds;		// min and max corner of the positions
+};
+
+enum MeshCacheFlags : uint32_t {
+	CACHE_OPTIMIZED = 1U << 0,
+	CACHE_PACKED = 1U << 1
+};
+
+// final VBO and EBO of an object file stored next to it (file.obj -> file.obj.scopmesh),
+// a valid cache is mapped and used as it is, without parsing the object file again
+class MeshCache {
+	public:
+		// flags: how the buffers were (or have to be) built, a cache with other flags isn't valid
+		explicit MeshCache( std::string const&, uint32_t = 0U );
+		~MeshCache( void ) = default;
+
+		// false if the cache is missing, broken or older than the object file or its material libraries
+		bool		load( std::shared_ptr<VBO>&, std::shared_ptr<EBO>&, std::vector<Material>& ) const;
+		// materials and the libraries they were read from, false if the cache couldn't be written
+		bool		save( VBO const&, EBO const*, std::vector<Material> const&, std::vector<fs::path> const& ) const;
+		fs::path	getCacheFile( void ) const noexcept;
+
+	private:
+		bool		_statSource( uint64_t&, int64_t& ) const noexcept;
+		uint64_t	_hashSource( void ) const;
+		// the source was touched without being changed
+		void		_updateSourceMtime( int64_t ) const noexcept;
+		std::string	_serializeMaterials( std::vector<Material> const&, std::vector<fs::path> const& ) const;
+		bool		_deserializeMaterials( std::string_view, std::vector<Material>& ) const;
+
+		fs::path	_objFile;
+		fs::path	_cacheFile;
+		uint32_t	_flags;
+};
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "define.hpp"
+
+
+// average cache miss ratio: vertexes transformed per triangle with a FIFO post-transform cache,
+// between 0.5 (best case on big meshes) and 3 (no reuse)
+float	computeACMR( uint32_t const*, size_t, uint32_t = SCOP_VERTEX_CACHE_SIZE );
+// reorders the triangles of an index buffer to reuse the vertexes in the post-transform cache
+// reference: Tom Forsyth - Linear-Speed Vertex Cache Optimisation (2006)
+void	optimizeVertexCache( uint32_t*, size_t, uint32_t );
+// reorders the vertexes of an interleaved buffer as first used by the index buffer, indexes are remapped
+void	reorderVertexesByFirstUse( float*, uint32_t, uint32_t, uint32_t*, size_t );
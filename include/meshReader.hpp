@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+class ParsedData;
+
+// format of a mesh file, found from its first bytes, then from its extension
+enum class MeshFormat : uint8_t {
+	OBJ,
+	STL,
+	PLY
+};
+
+MeshFormat	detectMeshFormat( std::string_view, std::string const& );
+char const*	meshFormatToString( MeshFormat ) noexcept;
+
+// binary STL: 80 bytes header, triangle count, then 50 bytes per triangle (normal, 3 vertexes, attribute)
+// reference: https://en.wikipedia.org/wiki/STL_(file_format)
+class StlReader {
+	public:
+		StlReader( void ) = default;
+		~StlReader( void ) = default;
+
+		// every triangle has its own 3 vertexes, the normals of the file are ignored: fillTexturesAndNormals() computes them
+		void	read( std::string_view, ParsedData& ) const;
+};
+
+// binary PLY (both endiannesses): x/y/z, nx/ny/nz and u/v (or s/t) of the vertexes, vertex_indices of the faces,
+// any other element or property is skipped
+// reference: https://paulbourke.net/dataformats/ply/
+class PlyReader {
+	public:
+		PlyReader( void ) = default;
+		~PlyReader( void ) = default;
+
+		void	read( std::string_view, ParsedData& );
+
+	private:
+		enum PlyType : uint8_t {
+			PLY_INT8,
+			PLY_UINT8,
+			PLY_INT16,
+			PLY_UINT16,
+			PLY_INT32,
+			PLY_UINT32,
+			PLY_FLOAT32,
+			PLY_FLOAT64
+		};
+
+		struct Property {
+			std::string	name;
+			PlyType		type;			// type of the items for a list
+			PlyType		countType;
+			bool		isList;
+		};
+
+		struct Element {
+			std::string				name;
+			uint64_t				count;
+			std::vector<Property>	properties;
+		};
+
+		// returns the body of the file, after end_header
+		std::string_view	_readHeader( std::string_view );
+		// each one returns the bytes of the body used by the element
+		size_t				_readVertexes( std::string_view, Element const&, ParsedData& ) const;
+		size_t				_readFaces( std::string_view, Element const&, ParsedData& ) const;
+		size_t				_skipElement( std::string_view, Element const& ) const;
+
+		static PlyType		_parseType( std::string_view );
+		static size_t		_typeSize( PlyType ) noexcept;
+		static double		_loadValue( PlyType, char const*, bool ) noexcept;
+
+		std::vector<Element>	_elements;
+		bool					_swapBytes = false;		// the endianness of the file isn't the one of the cpu
+};
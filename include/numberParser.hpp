@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+#include "faceStore.hpp"
+
+
+// numbers of the object files, same results as std::from_chars (and as stof/stoi before it) with a leading '+' accepted,
+// the fast paths avoid the generic conversion for the short decimals written by the exporters
+
+// Clinger's fast path: up to 19 significant digits and a power of ten up to 22 are exact in double,
+// the rest (and the rare double rounding to a float tie) goes through std::from_chars
+// reference: https://www.exploringbinary.com/fast-path-decimal-to-floating-point-conversion/
+std::from_chars_result	parseFloat( char const*, char const*, float& ) noexcept;
+// face index: positive up to UINT32_MAX, negative (relative) down to INT32_MIN
+std::from_chars_result	parseIndex( char const*, char const*, int64_t& ) noexcept;
+
+// face corner "v", "v/t", "v//n" or "v/t/n" read in a single scan, the numbers as written, 0 when missing
+struct FaceCorner {
+	FaceType				type = VERTEX;
+	std::array<int64_t,3>	values{0, 0, 0};	// vertex, texture, normal
+};
+
+// invalid_argument if a number is missing or malformed or the corner has more than 3 numbers
+std::errc				parseFaceCorner( std::string_view, FaceCorner& ) noexcept;
+
+// words of the obj and mtl lines, blanks are spaces, tabs and the '\r' left by files saved on windows
+std::string_view		trimBlanks( std::string_view ) noexcept;
+// returns the first word of content and moves content past it, empty view when nothing is left
+std::string_view		nextToken( std::string_view& ) noexcept;
+// parseFloat on a word, ParsingException if it doesn't start with a number
+float					tokenToFloat( std::string_view );
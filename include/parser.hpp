@@ -3,53 +3,21 @@
 #include <array>
 #include <list>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <memory>
+#include <functional>
 #include <cstdint>
 #include <filesystem>
 
 #include "math/vector.hpp"
+#include "faceStore.hpp"
+#include "threadPool.hpp"
+#include "lineScanner.hpp"
+#include "inputStream.hpp"
+#include "meshReader.hpp"
 
 
-enum FaceType {
-	VERTEX,
-	VERTEX_TEXT,
-	VERTEX_VNORM,
-	VERTEX_TEXT_VNORM
-};
-
-std::string	faceToString( FaceType );
-
-class Face {
-	public:
-		Face( void ) = default;
-		explicit Face( FaceType type ) noexcept : _type(type), _smoothing(0) {};
-		Face( FaceType type, std::vector<VectUI3> const& coors ) noexcept : _type(type), _indexes(coors), _smoothing(0) {};
-		~Face( void ) = default;
-
-		void setFaceType( FaceType ) noexcept;
-		void setIndexes( std::vector<VectUI3> const& ) noexcept;
-		void setObject( std::string const& ) noexcept;
-		void setGroup( std::string const& ) noexcept;
-		void setMaterial( std::string const& ) noexcept;
-		void setSmoothing( uint32_t ) noexcept;
-
-		FaceType 						getFaceType( void ) const noexcept;
-		std::vector<VectUI3> const&		getIndexes( void ) const noexcept;
-		std::string 					getObject( void ) const noexcept;
-		std::string 					getGroup( void ) const noexcept;
-		std::string 					getMaterial( void ) const noexcept;
-		uint32_t 						getSmoothing( void ) const noexcept;
-		
-	private:
-		FaceType 				_type;
-		std::vector<VectUI3>	_indexes;
-		std::string 			_object;
-		std::string 			_group;
-		std::string 			_material;
-		uint32_t 				_smoothing;
-};
-
 class Line {
 	public:
 		Line( void ) = default;
@@ -75,40 +43,91 @@ class Line {
 		uint32_t				_smoothing;
 };
 
-std::ostream& operator<<( std::ostream&, FaceType );
-std::ostream& operator<<( std::ostream&, Face const& );
 std::ostream& operator<<( std::ostream&, Line const& );
 
 class ParsedData;
 
 namespace fs = std::filesystem;
 
+// called on the thread of parse() every time a block of the file is parsed:
+// the data parsed so far and the first face of the block
+using ParseProgress = std::function<void( ParsedData const&, size_t )>;
+
 class FileParser {
 	public:
-		FileParser( void ) noexcept : _currentSmoothing(0) {}; 
+		FileParser( void ) noexcept : _currentObject(0), _currentGroup(0), _currentSmoothing(0), _currentMaterial(0) {}; 
 		~FileParser( void ) = default;
 		// reference https://en.wikipedia.org/wiki/Wavefront_.obj_file
-		ParsedData	parse( std::string const& );
+		// with more threads the file is split in chunks parsed in parallel and merged in order,
+		// binary STL and PLY files (found from their first bytes or extension) are handed to their reader
+		ParsedData	parse( std::string const&, uint32_t = 1 );
+		ParsedData	parse( std::string const&, ThreadPool& );
+		// with a progress the file is parsed in blocks of SCOP_PARSE_PROGRESS_BLOCK bytes, each one reported
+		// as soon as it's merged; binary files are reported once read
+		void		setProgress( ParseProgress );
+
+		// "-" is stdin, gzip and zstd files are decompressed on the fly (bounded memory, no cache possible)
+		MeshFormat	getFormat( void ) const noexcept;
+		Compression	getCompression( void ) const noexcept;
+		uint64_t	getReadBytes( void ) const noexcept;	// bytes read from the disk by the last parse
+		uint64_t	getInputBytes( void ) const noexcept;	// bytes of obj text parsed by the last parse
 
 	private:
-		void		_parseDirective( std::string const&, ParsedData& );
-		fs::path _createFile( std::string const& ) const;
-		VectF3 		_createVertex( std::string const& ) const;
-		VectF2 		_createTexture( std::string const& ) const;
-		VectF3 		_createVertexNorm( std::string const& ) const;
-		VectF3		_createSpaceVertex( std::string const& ) const;
-		Face 		_createFace( std::string const& ) const;
-		Line 		_createLine( std::string const& ) const;
-
-		std::string _trimString( std::string const& ) const noexcept;
-		FaceType	_getFaceType( std::string const& ) const noexcept;
-		float		_parseFloat( std::string const& ) const;
-		int32_t		_parseInt( std::string const& ) const;
-		uint32_t	_parseUint( std::string const& ) const;
+		enum StateField {
+			STATE_OBJECT,
+			STATE_GROUP,
+			STATE_MATERIAL,
+			STATE_SMOOTHING
+		};
+
+		// face index written as negative number (relative to the end of the list) parsed inside a chunk,
+		// can be resolved only when the size of the previous chunks is known
+		struct RelativeIndex {
+			size_t		face;		// position of the face in the chunk
+			uint32_t	corner;		// corner of the face
+			uint32_t	component;	// 0: vertex, 1: texture, 2: normal
+			int64_t		index;		// index from the start of the chunk, negative if it points to a previous chunk
+			int32_t		value;		// number as written in the file
+		};
+
+		void		_parseStream( std::string const&, ThreadPool&, ParsedData& );
+		void		_parseBlock( std::string_view, ThreadPool&, ParsedData& );
+		void		_parseParallel( std::string_view, ThreadPool&, uint32_t, ParsedData& );
+		void		_mergeChunk( ParsedData&, ParsedData&, FileParser const&, std::array<size_t,3> const& );
+		void		_checkRelativeIndexes( FileParser const&, std::array<size_t,3> const& ) const;
+		void		_parseBuffer( std::string_view, ParsedData& );
+		void		_parseDirective( std::string_view, ParsedData& );
+		void		_parseContent( ObjDirective, std::string_view, std::string_view, ParsedData& );
+		void		_setState( StateField, ParsedData const& ) noexcept;
+		fs::path	_createFile( std::string_view ) const;
+		VectF3 		_createVertex( std::string_view ) const;
+		VectF2 		_createTexture( std::string_view ) const;
+		VectF3 		_createVertexNorm( std::string_view ) const;
+		VectF3		_createSpaceVertex( std::string_view ) const;
+		void 		_createFace( std::string_view, ParsedData& );
+		Line 		_createLine( std::string_view, ParsedData const& ) const;
+
+		uint32_t	_parseUint( std::string_view ) const;
+		void		_reportProgress( ParsedData const& );
 
 		fs::path	_objFile;
-		std::string				_currentObject;
-		std::string				_currentGroup;
-		int32_t					_currentSmoothing;
-		std::string				_currentMaterial;
+		// object, group and material are ids in the names of the faces of the data being parsed
+		uint32_t				_currentObject;
+		uint32_t				_currentGroup;
+		uint32_t				_currentSmoothing;
+		uint32_t				_currentMaterial;
+		std::vector<VectUI3>	_corners;	// corners of the face being parsed, reused for every face
+		MeshFormat				_format = MeshFormat::OBJ;
+		Compression				_compression = Compression::NONE;
+		uint64_t				_readBytes = 0U;
+		uint64_t				_inputBytes = 0U;
+		ParseProgress			_progress;
+		size_t					_reportedFaces = 0U;
+
+		// chunk bookkeeping, used only by the worker parsers of _parseParallel()
+		bool						_isChunk = false;
+		std::array<bool,4>			_stateSet{false, false, false, false};
+		std::array<size_t,4>		_inheritedFaces{0, 0, 0, 0};	// faces parsed before the chunk sets its own o/g/usemtl/s
+		std::array<size_t,4>		_inheritedLines{0, 0, 0, 0};
+		std::vector<RelativeIndex>	_relativeIndexes;
 };
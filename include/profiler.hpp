@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+
+// scoped zones of the loading steps and of the render loop, written as a chrome trace-event file
+// (open it in ui.perfetto.dev or chrome://tracing); only built with make PROFILE=1,
+// otherwise SCOP_ZONE and SCOP_THREAD_NAME compile to nothing
+#ifdef SCOP_PROFILE
+
+// records the zones of every thread while it exists, the trace file is written when it's destroyed:
+// the threads recording have to be stopped by then
+class Profiler {
+	public:
+		explicit Profiler( std::string const& );
+		Profiler( Profiler const& ) = delete;
+		Profiler& operator=( Profiler const& ) = delete;
+		~Profiler( void ) noexcept;
+
+		static bool		isRecording( void ) noexcept;
+		// nanoseconds since the profiler started
+		static int64_t	now( void ) noexcept;
+		// name must outlive the profiler: zones are named with string literals
+		static void		record( char const*, int64_t, int64_t ) noexcept;
+		static void		nameThread( std::string const& ) noexcept;
+
+	private:
+		void	_write( void ) const;
+
+		std::string	_traceFile;
+};
+
+class ProfileZone {
+	public:
+		explicit ProfileZone( char const* name ) noexcept : _name(name), _start(Profiler::isRecording() ? Profiler::now() : -1) {}
+		ProfileZone( ProfileZone const& ) = delete;
+		ProfileZone& operator=( ProfileZone const& ) = delete;
+		~ProfileZone( void ) noexcept {
+			if (this->_start >= 0)
+				Profiler::record(this->_name, this->_start, Profiler::now());
+		}
+
+	private:
+		char const*	_name;
+		int64_t		_start;		// -1: the profiler isn't recording
+};
+
+# define SCOP_ZONE_CONCAT_(a, b) a##b
+# define SCOP_ZONE_CONCAT(a, b) SCOP_ZONE_CONCAT_(a, b)
+// zone from here to the end of the scope
+# define SCOP_ZONE(name) ProfileZone SCOP_ZONE_CONCAT(scopZone, __LINE__)(name)
+# define SCOP_THREAD_NAME(name) Profiler::nameThread(name)
+
+#else
+
+# define SCOP_ZONE(name) ((void)0)
+# define SCOP_THREAD_NAME(name) ((void)0)
+
+#endif
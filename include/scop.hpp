@@ -1,12 +1,24 @@
 #pragma once
 #include <cstdint>
 #include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <string>
+#include <array>
+#include <optional>
 #include <GLFW/glfw3.h>
 
 #include "math/matrix.hpp"
 #include "define.hpp"
 #include "parser.hpp"
 #include "data.hpp"
+#include "material.hpp"
+#include "spscQueue.hpp"
+#include "textureContainer.hpp"
+#include "cameraPath.hpp"
 
 
 class GraphicGL {
@@ -16,6 +28,7 @@ class GraphicGL {
 		
 		virtual void	updateShader( void );
 		void			reset( void ) noexcept;
+		Matrix4 const&	getTransformation( void ) const noexcept;
 		
 	protected:
 		GLuint	_shader;
@@ -32,6 +45,7 @@ class ModelGL : public GraphicGL {
 		void	rotate( float, float, float ) noexcept;
 		void	translate( VectF3 const& ) noexcept;
 		void	scale( VectF3 const& ) noexcept;
+		void	setTransformation( Matrix4 const& ) noexcept;
 };
 
 class CameraGL : public GraphicGL{
@@ -51,6 +65,8 @@ class CameraGL : public GraphicGL{
 		void	resetPosition( void ) noexcept;
 		void	rotate( float, float, float ) noexcept;
 		void	updateShader( void ) override;
+		CameraState	getState( void ) const noexcept;
+		void		setState( CameraState const& ) noexcept;
 
 	protected:
 		VectF3 const	_startPosition;	// store it for when position is reset
@@ -75,15 +91,69 @@ class ProjectionGL : public GraphicGL{
 		float	_aspect;
 };
 
+// locations of the uniforms set for every material, -1 if the shader doesn't use them
+struct MaterialUniforms {
+	GLint	useMaterial = -1;
+	GLint	ambient = -1;
+	GLint	diffuse = -1;
+	GLint	specular = -1;
+	GLint	shininess = -1;
+};
+
+// texture object showing a placeholder until its image is decoded (or its .dds read) and uploaded
+struct PendingTexture {
+	GLuint					texture;
+	std::string				path;
+	std::future<Texture>	image;
+};
+
+// vertex of the preview: position and RGBA8 color
+struct PreviewVertex {
+	VectF3		position;
+	uint32_t	color;
+};
+
+// what a parsed block of the file adds to the preview drawn while the final mesh is built: the vertexes
+// that follow the ones of the previous blocks, its faces fanned from their first corner
+struct PreviewBlock {
+	std::vector<PreviewVertex>	vertexes;
+	std::vector<uint32_t>		indexes;	// in the vertexes of the whole file
+};
+
+// piece of the mesh handed by the loader thread to the render thread: vertexes [firstVertex, firstVertex + nVertexes)
+// and indexes [firstIndex, firstIndex + nIndexes) of the buffers, shared by all the chunks of the mesh
+struct MeshChunk {
+	std::shared_ptr<VBO>					vbo;
+	std::shared_ptr<EBO>					ebo;		// null if the mesh has no faces
+	std::shared_ptr<std::vector<Material>>	materials;
+	uint32_t								firstVertex = 0U;
+	uint32_t								nVertexes = 0U;
+	uint32_t								firstIndex = 0U;
+	uint32_t								nIndexes = 0U;
+	std::shared_ptr<PreviewBlock>			preview;	// set on the chunks of the preview, the other fields are empty
+};
+
 class ScopGL {
 	public:
 		ScopGL() noexcept = default;
 		~ScopGL( void ) noexcept;
 
-		void parseFile( std::string const& );
-		void createWindow( int32_t, int32_t );
+		// starts loading the object file on a worker thread, the render loop shows the mesh as it arrives:
+		// a preview of the faces while the file is parsed, then the final mesh;
+		// the object file is parsed only if its mesh cache is missing or outdated
+		void parseFile( std::string const&, uint32_t = SCOP_PARSE_THREADS, bool = SCOP_USE_MESH_CACHE, bool = SCOP_OPTIMIZE_MESH, bool = SCOP_PACK_VERTEXES );
+		// a hidden window (visible false) works without a display too: it falls back to an OSMesa context
+		void createWindow( int32_t, int32_t, bool = true );
 		void initGL( std::string const&, std::string const&, std::string const& );
 		void loop( void );
+		// instead of loop(): waits for the whole mesh, then renders frames offscreen along a scripted path
+		// and prints their times
+		// along the replayed path if one is loaded
+		void benchmark( uint32_t );
+		// loop() writes the camera and model of every frame to the file when it ends
+		void recordPath( std::string const& );
+		// loop() and benchmark() draw the frames of the file, one every SCOP_REPLAY_TIMESTEP, instead of the input
+		void replayPath( std::string const& );
 
 		void resetCanvaSize( uint32_t, uint32_t );
 		void closeWindow( void );
@@ -93,12 +163,41 @@ class ScopGL {
 		uint32_t				_widthWindow = 0U;
 		uint32_t				_heightWindow = 0U;
 		GLuint					_texture = 0U;
+		// texture of every material, the default texture if the material has none
+		std::vector<GLuint>		_materialTextures;
+		MaterialUniforms		_materialUniforms;
+		GLint					_blendingUniform = -1;
+		// textures still decoding, uploaded through the pixel buffer one per frame
+		std::vector<PendingTexture>	_pendingTextures;
+		GLuint						_pixelBuffer = 0U;
+		// compressed formats sampled by the driver, the others are decompressed on the CPU
+		bool						_supportsS3TC = false;
+		bool						_supportsBPTC = false;
+		// offscreen target of benchmark(): color and depth renderbuffers
+		GLuint						_framebuffer = 0U;
+		std::array<GLuint,2>		_renderbuffers{};
 		GLuint					_shaderProgram = 0U;
 		GLuint					_VBO = 0U;
 		GLuint					_EBO = 0U;
 		GLuint					_VAO = 0U;
 		std::shared_ptr<VBO>	_VBOdata;
 		std::shared_ptr<EBO>	_EBOdata;
+		std::vector<Material>	_materials;
+
+		// background loading, the render thread uploads a few chunks per frame
+		std::thread										_loader;
+		SpscQueue<MeshChunk,SCOP_STREAM_QUEUE_SIZE>		_chunks;
+		std::atomic<bool>								_loadingDone{false};
+		std::atomic<bool>								_stopLoading{false};
+		std::exception_ptr								_loadingError;		// read only once _loadingDone is set
+		uint32_t										_uploadedVertexes = 0U;
+		uint32_t										_uploadedIndexes = 0U;
+		// drawn until the final mesh is uploaded, the buffers grow with the blocks parsed
+		GLuint											_previewVAO = 0U;
+		std::array<GLuint,2>							_previewBuffers{};		// vertexes, indexes
+		std::array<size_t,2>							_previewCapacities{};	// bytes
+		uint32_t										_previewVertexes = 0U;
+		uint32_t										_previewIndexes = 0U;
 
 		// for fading transition texture <-> color
 		float const	_fadingDuration = 1.0f;
@@ -109,6 +208,12 @@ class ScopGL {
 
 		float	_currCursorX = 0.0f;
 		float	_currCursorY = 0.0f;
+		float	_lastFrameTime = 0.0f;		// of the last _moveCamera, for the time between two frames
+
+		// --record, --replay
+		std::string					_recordFile;
+		CameraPath					_recording;
+		std::optional<CameraPath>	_replay;
 
 		std::unique_ptr<ModelGL>		_model;
 		std::unique_ptr<CameraGL>		_camera;
@@ -116,13 +221,40 @@ class ScopGL {
 
 		void 		_createShader( GLenum type, std::string const&);
 		uint32_t	_loadShader( GLenum, std::string const& );
-		void 		_loadTexture( std::string const& );
+		// the texture object is returned at once, the image is decoded on a worker thread,
+		// a .dds next to the image and not older than it is read instead
+		GLuint 		_loadTexture( std::string const& );
+		void		_receiveTextures( void );
+		void		_uploadTexture( GLuint, Texture const& );
+		void		_detectTextureCompression( void );
+		bool		_isTextureReady( GLuint ) const noexcept;
+		void		_loadMaterials( void );
+		// returns the draw calls made
+		uint32_t	_draw( void );
 		void		_setupCallbacks( void );
 		void		_loadBuffersInGPU( void );
+		void		_receiveChunks( void );
+		void		_uploadChunk( MeshChunk const& );
+		void		_uploadPreview( PreviewBlock const& );
+		void		_appendToBuffer( GLenum, GLuint&, size_t&, size_t, void const*, size_t );
+		uint32_t	_drawPreview( void );
+		void		_deletePreview( void );
+		bool		_isMeshUploaded( void ) const noexcept;
+		void		_loadFile( std::string, uint32_t, bool, bool, bool ) noexcept;
+		void		_streamChunks( std::shared_ptr<VBO> const&, std::shared_ptr<EBO> const&, std::shared_ptr<std::vector<Material>> const& );
+		// the vertexes parsed after the ones already sent and the faces from the one given
+		void		_streamPreview( ParsedData const&, size_t, uint32_t& );
+		// false if the loading was stopped while the queue was full
+		bool		_pushChunk( MeshChunk&& );
 		void		_moveCamera( void );
 		void		_centerCursor( void );
 		void		_toggleTextures( void );
 		void		_resetCamera( void );
 		void		_rotateCamera( float, float );
 		void		_fading( void );
+		void		_createFramebuffer( void );
+		void		_waitForMesh( void );
+		void		_scriptFrame( float ) noexcept;
+		PathFrame	_getFrameState( double ) const noexcept;
+		void		_setFrameState( PathFrame const& ) noexcept;
 };
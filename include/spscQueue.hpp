@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <optional>
+#include <cstddef>
+
+
+// lock-free bounded queue for one producer thread and one consumer thread,
+// SIZE has to be a power of 2: a slot is found by masking the ever growing positions
+template <typename T, size_t SIZE>
+class SpscQueue {
+	static_assert(SIZE > 0 and (SIZE & (SIZE - 1)) == 0, "SpscQueue size must be a power of 2");
+
+	public:
+		SpscQueue( void ) = default;
+		SpscQueue( SpscQueue const& ) = delete;
+		SpscQueue& operator=( SpscQueue const& ) = delete;
+		~SpscQueue( void ) = default;
+
+		// producer only, false if the queue is full
+		bool				tryPush( T&& );
+		// consumer only, empty if there is nothing to pop
+		std::optional<T>	tryPop( void );
+		bool				empty( void ) const noexcept;
+
+	private:
+		std::array<T,SIZE>	_slots;
+		// head and tail on their own cache lines, each written by one thread only
+		alignas(64) std::atomic<size_t>	_head{0U};	// next slot to pop
+		alignas(64) std::atomic<size_t>	_tail{0U};	// next slot to push
+};
+
+#include "spscQueue.tpp"
@@ -0,0 +1,29 @@
+#include "spscQueue.hpp"
+
+
+template <typename T, size_t SIZE>
+bool SpscQueue<T,SIZE>::tryPush( T&& value ) {
+	size_t tail = this->_tail.load(std::memory_order_relaxed);
+	if (tail - this->_head.load(std::memory_order_acquire) == SIZE)
+		return false;
+	this->_slots[tail & (SIZE - 1)] = std::move(value);
+	// the slot is written before the consumer can see it
+	this->_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t SIZE>
+std::optional<T> SpscQueue<T,SIZE>::tryPop( void ) {
+	size_t head = this->_head.load(std::memory_order_relaxed);
+	if (head == this->_tail.load(std::memory_order_acquire))
+		return std::nullopt;
+	std::optional<T> value(std::move(this->_slots[head & (SIZE - 1)]));
+	// the slot is read before the producer can reuse it
+	this->_head.store(head + 1, std::memory_order_release);
+	return value;
+}
+
+template <typename T, size_t SIZE>
+bool SpscQueue<T,SIZE>::empty( void ) const noexcept {
+	return this->_head.load(std::memory_order_acquire) == this->_tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+// formats of a texture in memory, BC formats are blocks of 4x4 pixels of 8 (BC1) or 16 bytes (BC3, BC7)
+enum class TextureFormat : uint32_t {
+	RGBA8,
+	BC1,	// RGB and 1 bit alpha
+	BC3,	// RGB of BC1 and interpolated alpha
+	BC7		// RGBA, only read: the converter doesn't encode it
+};
+
+// mip level inside Texture::data
+struct TextureLevel {
+	uint32_t	width;
+	uint32_t	height;
+	size_t		offset;
+	size_t		size;
+};
+
+// image and its mip chain, levels[0] is the full size,
+// rows go bottom-up as OpenGL reads them (DDS written by other tools show flipped)
+struct Texture {
+	TextureFormat				format = TextureFormat::RGBA8;
+	std::vector<TextureLevel>	levels;
+	std::vector<uint8_t>		data;
+};
+
+bool		isCompressed( TextureFormat ) noexcept;
+std::string	formatToString( TextureFormat );
+size_t		getLevelSize( TextureFormat, uint32_t, uint32_t ) noexcept;
+// true if a pixel of the RGBA8 level 0 isn't opaque
+bool		hasAlpha( Texture const& ) noexcept;
+
+// RGBA8 image with its full mip chain, every level is the 2x2 box filter of the previous one
+Texture	buildMipChain( uint8_t const*, uint32_t, uint32_t );
+// RGBA8 to BC1 or BC3: endpoints on the principal axis of the colors of every block
+Texture	compressTexture( Texture const&, TextureFormat );
+// BC1 or BC3 to RGBA8, for drivers that can't sample the compressed format
+Texture	decompressTexture( Texture const& );
+
+// DDS container with the mip chain: DXT1, DXT5, DX10 (BC1, BC3, BC7, RGBA8) or 32 bits RGBA
+// reference: https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dx-graphics-dds-pguide
+Texture	readDDS( std::string const& );
+void	writeDDS( std::string const&, Texture const& );
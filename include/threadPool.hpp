@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+
+
+// fixed set of threads started once and reused for every parallel step of the loading,
+// the thread calling run() works too: a pool of n threads starts n - 1 workers
+class ThreadPool {
+	public:
+		explicit ThreadPool( uint32_t );
+		ThreadPool( ThreadPool const& ) = delete;
+		ThreadPool& operator=( ThreadPool const& ) = delete;
+		~ThreadPool( void ) noexcept;
+
+		uint32_t			size( void ) const noexcept;
+		// bounds of contiguous ranges splitting [0, count), at most one per thread and of at least minSize elements
+		std::vector<size_t>	split( size_t, size_t ) const;
+		// calls task(i) for every i in [0, nTasks) and waits for all of them,
+		// the exception of the first failed task (in task order) is rethrown
+		void				run( size_t, std::function<void(size_t)> const& );
+
+	private:
+		void	_work( void ) noexcept;
+		void	_runTasks( void ) noexcept;
+
+		std::vector<std::thread>			_workers;
+		std::mutex							_mutex;
+		std::condition_variable				_wakeUp;
+		std::condition_variable				_finished;
+		// current job, workers only join it between wakeUp and the end of the job
+		std::function<void(size_t)> const*	_task = nullptr;
+		size_t								_nTasks = 0U;
+		std::atomic<size_t>					_nextTask{0U};
+		size_t								_doneTasks = 0U;
+		uint32_t							_activeWorkers = 0U;
+		uint64_t							_job = 0U;
+		std::vector<std::exception_ptr>		_errors;
+		bool								_stop = false;
+};
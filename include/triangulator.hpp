@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <utility>
+#include <cstdint>
+
+#include "math/vector.hpp"
+
+
+// corners of a triangle, as positions in the polygon
+using Triangle = std::array<uint32_t,3>;
+
+// triangulation of a simple polygon projected on its plane, by ear clipping
+// reference: https://www.geometrictools.com/Documentation/TriangulationByEarClipping.pdf
+// quads cut their first ear, other convex polygons are split as a fan, the rest walk an indexed
+// ring of the corners; the ear test only checks the reflex corners whose z-order code falls
+// in the range of the candidate ear, so big polygons don't rescan every other corner
+class Triangulator {
+	public:
+		Triangulator( void ) = default;
+		~Triangulator( void ) = default;
+
+		// appends the triangles to the vector, the last one is made by the 3 corners left
+		void	triangulate( std::vector<VectF2> const&, std::vector<Triangle>& );
+
+	private:
+		void		_triangulateQuad( std::vector<Triangle>& ) const noexcept;
+		bool		_isConvexPolygon( void ) const noexcept;
+		void		_clipEars( std::vector<Triangle>& );
+		bool		_isConvex( uint32_t ) const noexcept;
+		bool		_isEar( uint32_t ) const noexcept;
+		void		_clip( uint32_t, std::vector<Triangle>& ) noexcept;
+		uint32_t	_zOrder( VectF2 const& ) const noexcept;
+		uint32_t	_nextZInBox( uint32_t, uint32_t, uint32_t ) const noexcept;
+
+		std::vector<VectF2> const*					_points = nullptr;
+		float										_orientation = 1.0f;	// 1 if corners are CCW, -1 if CW
+		uint32_t									_remaining = 0U;
+		// ring of the corners still to clip
+		std::vector<uint32_t>						_prev;
+		std::vector<uint32_t>						_next;
+		std::vector<uint8_t>						_reflex;
+		// reflex corners sorted by z-order code, a corner that turns convex is just flagged
+		std::vector<std::pair<uint32_t,uint32_t>>	_reflexByZ;
+		VectF2										_min{0.0f, 0.0f};
+		float										_scale = 0.0f;
+};
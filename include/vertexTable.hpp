@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+#include "data.hpp"
+
+
+// set of the unique vertexes already written in a VBO, open addressing with linear probing:
+// a slot keeps the hash and the VBO index + 1 of a vertex (0 is an empty slot),
+// the vertexes are compared with the copy already in the VBO so keys aren't stored twice
+class VertexTable {
+	public:
+		// sized once for the number of corners: never resized and at most half full
+		VertexTable( size_t, float const*, uint32_t );
+		~VertexTable( void ) = default;
+
+		// VBO index of the vertex and true if it wasn't in the table, in that case it takes newIndex
+		std::pair<uint32_t,bool>	insert( SerializedVertex const&, uint32_t );
+
+	private:
+		uint32_t	_hash( SerializedVertex const& ) const noexcept;
+
+		std::vector<std::pair<uint32_t,uint32_t>>	_slots;
+		size_t										_mask;
+		float const*								_vbo;
+		uint32_t									_vertexSize;	// floats between two vertexes in the VBO
+};
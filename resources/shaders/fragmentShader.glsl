@@ -2,14 +2,32 @@
 
 in vec3 colorRGB;
 in vec2 textCoor;
+in vec3 viewNormal;
+in vec3 viewPos;
 out vec4 FragColor;
 
 uniform sampler2D myTexture;
 uniform float blendingLevel;
 
+// material of the faces being drawn, faces without material keep the vertex colors
+uniform bool useMaterial;
+uniform vec3 ambientColor;
+uniform vec3 diffuseColor;
+uniform vec3 specularColor;
+uniform float shininess;
+
 void main()
 {
+    vec3 color = colorRGB;
+    if (useMaterial) {
+        // the light is at the camera: the half vector is the view direction
+        vec3 toCamera = normalize(-viewPos);
+        vec3 normal = length(viewNormal) > 0.0 ? normalize(viewNormal) : toCamera;
+        float lambert = abs(dot(normal, toCamera));
+        float specular = shininess > 0.0 ? pow(lambert, shininess) : 0.0;
+        color = ambientColor * 0.1 + diffuseColor * lambert + specularColor * specular;
+    }
     vec4 texColor = texture(myTexture, textCoor);
-    vec4 rgbColor = vec4(colorRGB, 1.0);
+    vec4 rgbColor = vec4(color, 1.0);
     FragColor = mix(rgbColor, texColor, blendingLevel);
 }
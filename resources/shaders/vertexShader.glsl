@@ -2,12 +2,14 @@
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTextCoord;
-layout (location = 2) in vec2 aNormCoord;
+layout (location = 2) in vec3 aNormal;
 layout (location = 3) in vec3 aColorRGB;
 
 out vec3 colorRGB;
 out vec2 textCoor;
 out vec3 fragPos;
+out vec3 viewNormal;
+out vec3 viewPos;
 
 uniform mat4 model;
 uniform mat4 view;
@@ -22,4 +24,6 @@ void main()
 	textCoor = aTextCoord;
     vec4 worldPos = model * vec4(aPos, 1.0);
     fragPos = worldPos.xyz;
+    viewPos = (view * worldPos).xyz;
+    viewNormal = mat3(view * model) * aNormal;
 }
@@ -52,6 +52,78 @@ void InputData::setTextureFile( InputData& input, std::optional<std::string> opt
     input.textureFile = optValue.value();
 }
 
+void InputData::setThreads( InputData& input, std::optional<std::string> optValue ) {
+    try {
+        int32_t threads = std::stoi(optValue.value());
+        if (threads < 1)
+            throw ParsingException("Number of threads has to be at least 1: " + optValue.value());
+        input.threads = threads;
+    } catch (std::bad_optional_access const&) {
+        throw ParsingException("Missing value for --threads");
+    } catch (std::invalid_argument const&) {
+        throw ParsingException("Wrong number input: " + optValue.value());
+    } catch (std::out_of_range const&) {
+        throw ParsingException("Out of range: " + optValue.value());
+    }
+}
+
+void InputData::setNoCache( InputData& input, std::optional<std::string> optValue ) {
+    (void)optValue;
+    input.useCache = false;
+}
+
+void InputData::setOptimize( InputData& input, std::optional<std::string> optValue ) {
+    (void)optValue;
+    input.optimize = true;
+}
+
+void InputData::setPacked( InputData& input, std::optional<std::string> optValue ) {
+    (void)optValue;
+    input.packed = true;
+}
+
+void InputData::setBakePath( InputData& input, std::optional<std::string> optValue ) {
+    if (optValue.has_value() == false or optValue.value().empty())
+        throw ParsingException("Missing value for --bake");
+    input.bakePath = optValue.value();
+}
+
+void InputData::setTraceFile( InputData& input, std::optional<std::string> optValue ) {
+    if (optValue.has_value() == false or optValue.value().empty())
+        throw ParsingException("Missing value for --trace");
+#ifndef SCOP_PROFILE
+    throw ParsingException("Tracing not supported (build with: make PROFILE=1)");
+#endif
+    input.traceFile = optValue.value();
+}
+
+void InputData::setBenchFrames( InputData& input, std::optional<std::string> optValue ) {
+    try {
+        int32_t frames = std::stoi(optValue.value());
+        if (frames < 1)
+            throw ParsingException("Number of frames has to be at least 1: " + optValue.value());
+        input.benchFrames = frames;
+    } catch (std::bad_optional_access const&) {
+        throw ParsingException("Missing value for --bench-frames");
+    } catch (std::invalid_argument const&) {
+        throw ParsingException("Wrong number input: " + optValue.value());
+    } catch (std::out_of_range const&) {
+        throw ParsingException("Out of range: " + optValue.value());
+    }
+}
+
+void InputData::setRecordFile( InputData& input, std::optional<std::string> optValue ) {
+    if (optValue.has_value() == false or optValue.value().empty())
+        throw ParsingException("Missing value for --record");
+    input.recordFile = optValue.value();
+}
+
+void InputData::setReplayFile( InputData& input, std::optional<std::string> optValue ) {
+    if (optValue.has_value() == false or optValue.value().empty())
+        throw ParsingException("Missing value for --replay");
+    input.replayFile = optValue.value();
+}
+
 void InputData::setHelpMode( InputData& input, std::optional<std::string> optValue ) {
     (void)optValue;
     input.helpmode = true;
@@ -73,7 +145,7 @@ InputData InputData::parseArgs(int32_t argc, char* argv[]) {
 				throw ParsingException("Invalid argument with value: " + arg);
             value = arg.substr(eqPos + 1);
             arg = arg.substr(0, eqPos);
-        } else if ((i + 1 < argc) and (argv[i + 1][0] != '-'))		// or is: --key value
+        } else if ((i + 1 < argc) and (argv[i + 1][0] != '-' or std::string(argv[i + 1]) == "-"))		// or is: --key value ("-": stdin)
             value = argv[++i];
 
         auto mapOption = flagMap.find(arg);
@@ -85,5 +157,8 @@ InputData InputData::parseArgs(int32_t argc, char* argv[]) {
         if (it != flagActions.cend())
             it->second(opts, value);	// run action depending on option type
 	}
+    // a recording comes from the keyboard and the mouse of the window
+    if (opts.recordFile.empty() == false and (opts.replayFile.empty() == false or opts.benchFrames > 0))
+        throw ParsingException("--record can't be used with --replay or --bench-frames");
     return opts;
 }
@@ -0,0 +1,127 @@
+#include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+#include "cameraPath.hpp"
+#include "define.hpp"
+#include "exception.hpp"
+
+
+namespace {
+	// numbers of a frame: time, position, forward, up, model matrix, blending
+	constexpr size_t FRAME_NUMBERS = 1 + 3 * 3 + 16 + 1;
+
+	template <typename T>
+	void writeNumber( std::string& line, T value ) {
+		char buffer[32];
+		// without a precision to_chars writes the shortest text that reads back the same value
+		std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		if (line.empty() == false)
+			line += ' ';
+		line.append(buffer, result.ptr);
+	}
+
+	template <typename T>
+	bool readNumber( char const*& first, char const* last, T& value ) noexcept {
+		while (first != last and (*first == ' ' or *first == '\t'))
+			first++;
+		std::from_chars_result result = std::from_chars(first, last, value);
+		if (result.ec != std::errc{} or std::isfinite(value) == false)
+			return false;
+		first = result.ptr;
+		return true;
+	}
+}
+
+void CameraPath::push( PathFrame const& frame ) {
+	if (this->_frames.empty() == false and frame.time < this->_frames.back().time)
+		throw AppException("Camera path frames out of order");
+	this->_frames.push_back(frame);
+}
+
+PathFrame const& CameraPath::at( double time ) const {
+	if (this->_frames.empty())
+		throw AppException("Camera path empty");
+
+	double duration = this->getDuration();
+	if (duration > 0.0 and time > duration)
+		time = std::fmod(time, duration);
+	auto next = std::upper_bound(this->_frames.cbegin(), this->_frames.cend(), time, []( double t, PathFrame const& frame ) {
+		return t < frame.time;
+	});
+	return next == this->_frames.cbegin() ? *next : *(next - 1);
+}
+
+size_t CameraPath::size( void ) const noexcept {
+	return this->_frames.size();
+}
+
+double CameraPath::getDuration( void ) const noexcept {
+	return this->_frames.empty() ? 0.0 : this->_frames.back().time;
+}
+
+void CameraPath::save( std::string const& fileName ) const {
+	std::ofstream file(fileName);
+	if (!file)
+		throw AppException("Couldn't write camera path: " + fileName);
+
+	file << SCOP_CAMERA_PATH_HEADER << "\n# time position(3) forward(3) up(3) model(16) blending\n";
+	std::string line;
+	for (PathFrame const& frame : this->_frames) {
+		line.clear();
+		writeNumber(line, frame.time);
+		for (VectF3 const& vector : {frame.camera.position, frame.camera.forward, frame.camera.up}) {
+			for (float value : VectF3::to_array(vector))
+				writeNumber(line, value);
+		}
+		for (float value : frame.model)
+			writeNumber(line, value);
+		writeNumber(line, frame.blending);
+		file << line << '\n';
+	}
+	if (!file)
+		throw AppException("Couldn't write camera path: " + fileName);
+}
+
+CameraPath CameraPath::load( std::string const& fileName ) {
+	std::ifstream file(fileName);
+	if (!file)
+		throw ParsingException("Error while opening camera path: " + fileName);
+
+	std::string line;
+	if (!std::getline(file, line) or line != SCOP_CAMERA_PATH_HEADER)
+		throw ParsingException("Not a camera path (" + std::string(SCOP_CAMERA_PATH_HEADER) + " expected): " + fileName);
+
+	CameraPath path;
+	size_t nLine = 1U;
+	while (std::getline(file, line)) {
+		nLine++;
+		if (line.empty() or line[0] == '#')
+			continue;
+
+		PathFrame frame;
+		std::array<float,FRAME_NUMBERS - 1> values;
+		char const* first = line.data();
+		char const* last = line.data() + line.size();
+		bool valid = readNumber(first, last, frame.time);
+		for (size_t i=0; valid and i<values.size(); i++)
+			valid = readNumber(first, last, values[i]);
+		while (first != last and (*first == ' ' or *first == '\t' or *first == '\r'))
+			first++;
+		if (valid == false or first != last)
+			throw ParsingException(fileName + ":" + std::to_string(nLine) + ": " + std::to_string(FRAME_NUMBERS) + " numbers expected");
+		if (path._frames.empty() == false and frame.time < path._frames.back().time)
+			throw ParsingException(fileName + ":" + std::to_string(nLine) + ": time before the previous frame");
+
+		frame.camera.position = VectF3{values[0], values[1], values[2]};
+		frame.camera.forward = VectF3{values[3], values[4], values[5]};
+		frame.camera.up = VectF3{values[6], values[7], values[8]};
+		std::copy(values.begin() + 9, values.begin() + 25, frame.model.begin());
+		frame.blending = values[25];
+		path._frames.push_back(frame);
+	}
+	if (path._frames.empty())
+		throw ParsingException("Camera path without frames: " + fileName);
+	return path;
+}
@@ -1,21 +1,127 @@
 #include <algorithm>
 #include <unordered_map>
+#include <memory_resource>
+#include <string_view>
 #include <cmath>
 #include <cstring>
 
 #include "data.hpp"
+#include "triangulator.hpp"
+#include "vertexTable.hpp"
+#include "meshOptimizer.hpp"
 #include "math/utilities.hpp"
 #include "exception.hpp"
+#include "define.hpp"
+#include "profiler.hpp"
 
 
-float const* VBO::getData( void ) const {
+// slot of a vertex of a face out of the smoothing groups: the vertex and the direction of the face, rounded
+// so the triangles of a flat polygon match despite the ulps of their normals (and -0.0f)
+struct FlatSlotKey {
+	uint32_t				vertex;
+	std::array<int32_t,3>	normal;
+
+	bool operator==( FlatSlotKey const& other ) const noexcept {
+		return this->vertex == other.vertex and this->normal == other.normal;
+	}
+};
+
+struct FlatSlotHash {
+	size_t operator()( FlatSlotKey const& key ) const noexcept {
+		uint64_t hash = key.vertex;
+		for (int32_t value : key.normal)
+			hash = (hash ^ static_cast<uint32_t>(value)) * 0x100000001b3ULL;
+		return static_cast<size_t>(hash ^ (hash >> 32));
+	}
+};
+
+static uint16_t toHalfFloat( float value ) noexcept {
+	// IEEE 754 binary16, rounded to nearest even
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(float));
+	uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000U);
+	uint32_t absBits = bits & 0x7fffffffU;
+	if (absBits >= 0x7f800000U)		// inf or nan
+		return sign | 0x7c00U | (absBits > 0x7f800000U ? 0x0200U : 0U);
+	else if (absBits >= 0x477ff000U)	// rounds above 65504
+		return sign | 0x7c00U;
+	else if (absBits < 0x33000000U)	// rounds to 0
+		return sign;
+	else if (absBits < 0x38800000U) {	// subnormal
+		uint32_t mantissa = (absBits & 0x007fffffU) | 0x00800000U;
+		uint32_t shift = 126U - (absBits >> 23);
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1U << shift) - 1U);
+		uint32_t halfway = 1U << (shift - 1U);
+		if (rest > halfway or (rest == halfway and (half & 1U)))
+			half++;
+		return sign | static_cast<uint16_t>(half);
+	}
+	uint32_t half = (absBits - 0x38000000U) >> 13;	// exponent bias 127 -> 15
+	uint32_t rest = absBits & 0x1fffU;
+	if (rest > 0x1000U or (rest == 0x1000U and (half & 1U)))
+		half++;
+	return sign | static_cast<uint16_t>(half);
+}
+
+static uint32_t toPackedNormal( VectF3 const& normal ) noexcept {
+	// GL_INT_2_10_10_10_REV: x in the lowest bits, signed normalized, w unused
+	auto snorm10 = []( float value ) {
+		return static_cast<uint32_t>(static_cast<int32_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 511.0f))) & 0x3ffU;
+	};
+	return snorm10(normal.x) | (snorm10(normal.y) << 10) | (snorm10(normal.z) << 20);
+}
+
+static std::array<uint8_t,4> toPackedColor( VectF3 const& color ) noexcept {
+	auto unorm8 = []( float value ) {
+		return static_cast<uint8_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+	};
+	return {unorm8(color.x), unorm8(color.y), unorm8(color.z), 255U};
+}
+
+
+std::byte const* VBO::getData( void ) const {
+	if (this->mapping)
+		return reinterpret_cast<std::byte const*>(this->mapping->data() + this->offset);
 	return this->data.get();
 }
 
-uint32_t const* EBO::getData( void ) const {
+void VBO::computeBounds( void ) {
+	std::byte const* vertex = this->getData();
+	if (this->size == 0) {
+		this->bounds = {VectF3{0.0f, 0.0f, 0.0f}, VectF3{0.0f, 0.0f, 0.0f}};
+		return;
+	}
+	VectF3 low, high;
+	std::memcpy(&low, vertex, sizeof(VectF3));
+	high = low;
+	for (uint32_t i=1; i<this->size; i++) {
+		VectF3 position;
+		std::memcpy(&position, vertex + static_cast<size_t>(i) * this->stride, sizeof(VectF3));
+		low = VectF3{std::min(low.x, position.x), std::min(low.y, position.y), std::min(low.z, position.z)};
+		high = VectF3{std::max(high.x, position.x), std::max(high.y, position.y), std::max(high.z, position.z)};
+	}
+	this->bounds = {low, high};
+}
+
+std::byte const* EBO::getData( void ) const {
+	if (this->mapping)
+		return reinterpret_cast<std::byte const*>(this->mapping->data() + this->offset);
 	return this->data.get();
 }
 
+uint32_t EBO::getIndex( size_t i ) const {
+	std::byte const* index = this->getData() + i * this->stride;
+	if (this->stride == EBO_SHORT_STRIDE) {
+		uint16_t shortIndex;
+		std::memcpy(&shortIndex, index, sizeof(uint16_t));
+		return shortIndex;
+	}
+	uint32_t longIndex;
+	std::memcpy(&longIndex, index, sizeof(uint32_t));
+	return longIndex;
+}
+
 
 std::vector<fs::path> const& ParsedData::getTmlFiles( void ) const noexcept {
 	return this->_tmlFiles;
@@ -37,7 +143,7 @@ std::vector<VectF3> const& ParsedData::getParamSpaceVertices( void ) const noexc
 	return this->_paramSpaceVertices;
 }
 
-std::list<Face> const& ParsedData::getFaces( void ) const noexcept {
+FaceStore const& ParsedData::getFaces( void ) const noexcept {
 	return this->_faces;
 }
 
@@ -45,6 +151,10 @@ std::list<Line> const& ParsedData::getLines( void ) const noexcept {
 	return this->_lines;
 }
 
+std::vector<Material> const& ParsedData::getMaterials( void ) const noexcept {
+	return this->_materials;
+}
+
 std::shared_ptr<VBO> const& ParsedData::getVBO( void ) const {
 	if (!this->_VBOdata)
 		throw ParsingException("VBO not initialized, call .fillBuffers()");
@@ -58,145 +168,250 @@ std::shared_ptr<EBO> const& ParsedData::getEBO( void ) const {
 }
 
 bool ParsedData::hasFaces( void ) const noexcept {
-	return this->_faces.size() > 0;
+	return this->_faces.empty() == false;
 }
 
 void ParsedData::triangolate( void ) {
+	ThreadPool serial(1);
+	this->triangolate(serial);
+}
+
+void ParsedData::triangolate( ThreadPool& pool ) {
+	SCOP_ZONE("ParsedData::triangolate");
 	if (this->_triangolationDone)
 		return;
 
-	for (auto currentFace=this->_faces.cbegin(); currentFace != this->_faces.cend(); currentFace++) {
-		if (currentFace->getIndexes().size() == 3)
-			continue;
+	// every range of faces writes its triangles from the sum of the triangles of the ranges before it,
+	// a polygon with n corners becomes n - 2 triangles
+	std::vector<size_t> bounds = pool.split(this->_faces.size(), SCOP_PARALLEL_MIN_FACES);
+	std::vector<size_t> firstTriangle(bounds.size(), 0U);
+	for (size_t i=1; i<bounds.size(); i++) {
+		size_t nCorners = this->_faces.getFirstCorner(bounds[i]) - this->_faces.getFirstCorner(bounds[i - 1]);
+		firstTriangle[i] = firstTriangle[i - 1] + nCorners - (bounds[i] - bounds[i - 1]) * 2;
+	}
+	FaceStore triangles;
+	triangles.resize(firstTriangle.back(), 3);
+	triangles.getNames() = this->_faces.getNames();
+
+	pool.run(bounds.size() - 1, [&]( size_t range ) {
+		Triangulator triangulator;
+		std::vector<VectF2> polygon;
+		std::vector<Triangle> spawned;
+		size_t current = firstTriangle[range];
+		for (size_t i=bounds[range]; i<bounds[range + 1]; i++) {
+			VectUI3 const* corners = this->_faces.getCorners(i);
+			uint32_t nCorners = this->_faces.getCornersCount(i);
+			FaceType type = this->_faces.getFaceType(i);
+			FaceAttributes attributes = this->_faces.getAttributes(i);
+			if (nCorners == 3) {
+				triangles.set(current++, type, corners, attributes);
+				continue;
+			}
 
-		Face newFace(currentFace->getFaceType());
-
-		std::list<std::pair<VectUI3,VectF2>> vertexes = _create2Dvertexes(currentFace->getIndexes());
-		std::list<VectF2> convexVertexes;
-		std::list<VectF2> earVertexes;
-		std::list<VectF2> reflexVertexes;
-		// drop current polygon/face and insert N triangles
-		currentFace = this->_faces.erase(currentFace);
-
-		for (auto curr = vertexes.cbegin(); curr != vertexes.cend(); ++curr) {
-			if (this->_isConvex(curr, vertexes) == true) {
-				convexVertexes.push_back((*curr).second);
-				if (this->_isEar(curr, vertexes) == true)
-					earVertexes.push_back((*curr).second);
-			} else
-				reflexVertexes.push_back((*curr).second);
-		}
-		// do ear clipping, creating a triangle for every iteration
-		while (vertexes.size() > 3) {
-			newFace.setIndexes(this->_spawnTriangle(vertexes, convexVertexes, earVertexes, reflexVertexes));
-			currentFace = this->_faces.insert(currentFace, newFace);
+			this->_projectPolygon(corners, nCorners, polygon);
+			spawned.clear();
+			triangulator.triangulate(polygon, spawned);
+			// the triangles of a polygon are stored last spawned first
+			for (auto triangle = spawned.crbegin(); triangle != spawned.crend(); triangle++) {
+				std::array<VectUI3,3> triangleCorners{corners[(*triangle)[0]], corners[(*triangle)[1]], corners[(*triangle)[2]]};
+				triangles.set(current++, type, triangleCorners.data(), attributes);
+			}
 		}
-		std::vector<VectUI3> lastTriangle;
-		for (auto const& [index, _] : vertexes)
-			lastTriangle.push_back(index);
-		newFace.setIndexes(lastTriangle);
-		currentFace = this->_faces.insert(currentFace, newFace);
-	}
+	});
+	this->_faces = std::move(triangles);
 	this->_triangolationDone = true;
 }
 
 void ParsedData::fixTrianglesOrientation( void ) {
+	ThreadPool serial(1);
+	this->fixTrianglesOrientation(serial);
+}
+
+void ParsedData::fixTrianglesOrientation( ThreadPool& pool ) {
+	SCOP_ZONE("ParsedData::fixTrianglesOrientation");
 	if (this->_triangolationDone == false)
 		throw ParsingException("Faces must be triangolated, call .triangolate() first");
-		
+
+	// summed in one thread: the order of the sums doesn't change with the number of threads
 	VectF3 meshCenter{0.0f, 0.0f, 0.0f};
-	for (Face const& face : this->_faces) {
-		for ( VectUI3 const& index : face.getIndexes())
-			meshCenter += this->_vertexes[index.i1];
-	}
+	for (VectUI3 const& index : this->_faces.getAllCorners())
+		meshCenter += this->_vertexes[index.i1];
 	meshCenter /= static_cast<float>(this->_faces.size() * 3);
-	for (Face& face : this->_faces) {
-		std::vector<VectUI3> vertexIndex = face.getIndexes();
-		std::array<VectF3, 3> triangle{this->_vertexes[vertexIndex[0].i1], this->_vertexes[vertexIndex[1].i1], this->_vertexes[vertexIndex[2].i1]};
-		VectF3 normal = getNormal(triangle);
-		// center of the triangle
-		VectF3 faceCenter = (triangle[0] + triangle[1] + triangle[2]) / 3.0f;
-		VectF3 toOutside = faceCenter - meshCenter;
-		if ((normal * toOutside) < F_ZERO)
-			// swap vertexes position
-			std::swap(vertexIndex[1], vertexIndex[2]);
-		face.setIndexes(vertexIndex);
-	}
+
+	std::vector<size_t> bounds = pool.split(this->_faces.size(), SCOP_PARALLEL_MIN_FACES);
+	pool.run(bounds.size() - 1, [&]( size_t range ) {
+		for (size_t i=bounds[range]; i<bounds[range + 1]; i++) {
+			VectUI3* vertexIndex = this->_faces.getCorners(i);
+			std::array<VectF3, 3> triangle{this->_vertexes[vertexIndex[0].i1], this->_vertexes[vertexIndex[1].i1], this->_vertexes[vertexIndex[2].i1]};
+			VectF3 normal = getNormal(triangle);
+			// center of the triangle
+			VectF3 faceCenter = (triangle[0] + triangle[1] + triangle[2]) / 3.0f;
+			VectF3 toOutside = faceCenter - meshCenter;
+			if ((normal * toOutside) < F_ZERO)
+				// swap vertexes position
+				std::swap(vertexIndex[1], vertexIndex[2]);
+		}
+	});
 }
 
 void ParsedData::fillTexturesAndNormals( void ) {
+	ThreadPool serial(1);
+	this->fillTexturesAndNormals(serial);
+}
+
+void ParsedData::fillTexturesAndNormals( ThreadPool& pool ) {
+	SCOP_ZONE("ParsedData::fillTexturesAndNormals");
 	if (this->_triangolationDone == false)
 		throw ParsingException("Faces must be triangolated, call .triangolate() first");
 	else if (this->_dataFilled)
 		return;
 
-	uint32_t textureIndex = this->_textures.size();
-	uint32_t normalIndex = this->_normals.size();
-	for (Face& face : this->_faces) {
-		if (face.getFaceType() == VERTEX_TEXT_VNORM)
+	// the corners missing texture or normal get the ones generated for their vertex in their smoothing group:
+	// corners of the same vertex and group share the same index, so fillBuffers() can merge them.
+	// group 0 (no s, s off or s 0) is flat shaded: a vertex is shared only by the faces facing the same way
+	std::vector<size_t> bounds = pool.split(this->_faces.size(), SCOP_PARALLEL_MIN_FACES);
+	size_t nCorners = this->_faces.getAllCorners().size();
+	// the temporaries of this step (a map node per vertex) come from one arena, freed at once on return
+	std::pmr::monotonic_buffer_resource arena;
+	std::pmr::vector<VectF3> cornerNormals(nCorners, &arena);
+	pool.run(bounds.size() - 1, [&]( size_t range ) {
+		for (size_t i=bounds[range]; i<bounds[range + 1]; i++) {
+			if (this->_faces.getFaceType(i) != VERTEX_TEXT_VNORM)
+				this->_weightCornerNormals(this->_faces.getCorners(i), &cornerNormals[this->_faces.getFirstCorner(i)]);
+		}
+	});
+
+	std::pmr::unordered_map<uint64_t,uint32_t> slots(&arena);
+	std::pmr::unordered_map<FlatSlotKey,uint32_t,FlatSlotHash> flatSlots(&arena);
+	size_t nSmoothCorners = 0U;
+	for (size_t i=0; i<this->_faces.size(); i++) {
+		if (this->_faces.getFaceType(i) != VERTEX_TEXT_VNORM and this->_faces.getAttributes(i).smoothing != 0U)
+			nSmoothCorners += 3U;
+	}
+	slots.reserve(nSmoothCorners);
+	flatSlots.reserve(nCorners - nSmoothCorners);
+	std::pmr::vector<VectF3> slotNormals(&arena);
+	slotNormals.reserve(nCorners);
+	std::pmr::vector<uint32_t> slotVertexIndexes(&arena);
+	slotVertexIndexes.reserve(nCorners);
+	std::pmr::vector<uint32_t> cornerSlots(nCorners, &arena);
+	for (size_t i=0; i<this->_faces.size(); i++) {
+		if (this->_faces.getFaceType(i) == VERTEX_TEXT_VNORM)
 			continue;
-
-		std::vector<VectUI3> vertexIndex = face.getIndexes();
-		std::array<VectF3, 3> triangle{this->_vertexes[vertexIndex[0].i1], this->_vertexes[vertexIndex[1].i1], this->_vertexes[vertexIndex[2].i1]};
-
-		VectF3 normal = getNormal(triangle);
-		// texture
-		VectF3 helper;
-		if (fabs(normal.x) < 0.9f)
-			helper = VectF3{1.0f, 0.0f, 0.0f};
-		else
-			helper = VectF3{0.0f, 1.0f, 0.0f};
-		// building a basis orthonormal on the triangle
-		VectF3 u = normalize(helper ^ normal);
-		VectF3 v = normalize(normal ^ u);
-		std::array<float,3> uCoors;
-		std::array<float,3> vCoors;
-		// projecting vertexes on the plane
-		for (uint32_t i=0; i<vertexIndex.size(); i++) {
-			uCoors[i] = triangle[i] * u;
-			vCoors[i] = triangle[i] * v;
+		uint64_t smoothing = this->_faces.getAttributes(i).smoothing;
+		VectUI3 const* vertexIndex = this->_faces.getCorners(i);
+		size_t firstCorner = this->_faces.getFirstCorner(i);
+		FlatSlotKey flatKey{0U, {0, 0, 0}};
+		if (smoothing == 0U) {
+			VectF3 normal = getNormal(std::array<VectF3,3>{this->_vertexes[vertexIndex[0].i1], this->_vertexes[vertexIndex[1].i1], this->_vertexes[vertexIndex[2].i1]});
+			flatKey.normal = {static_cast<int32_t>(std::lround(normal.x * SCOP_FLAT_NORMAL_STEPS)),
+				static_cast<int32_t>(std::lround(normal.y * SCOP_FLAT_NORMAL_STEPS)), static_cast<int32_t>(std::lround(normal.z * SCOP_FLAT_NORMAL_STEPS))};
 		}
-		// ranges to normalise the projections in [0, 1]
-		float uMin = *std::min_element(uCoors.cbegin(), uCoors.cend());
-		float uMax = *std::max_element(uCoors.cbegin(), uCoors.cend());
-		float vMin = *std::min_element(vCoors.cbegin(), vCoors.cend());
-		float vMax = *std::max_element(vCoors.cbegin(), vCoors.cend());
-		// normal
-		// to avoid that small faces affect the result too much,
-		// every normal is weighted with the area of its triangle
-		float areaTriangle = 0.5f * getAbs(normal);
-		for (uint32_t i=0; i<vertexIndex.size(); i++) {
-			VectF2 uv{(uCoors[i] - uMin) / (uMax - uMin), (vCoors[i] - vMin) / (vMax - vMin)};
-			this->_textures.push_back(uv);
-
-			VectF3 smoothed = (this->_vertexes[vertexIndex[i].i1] + normal) * areaTriangle;
-			this->_normals.push_back(normalize(smoothed));
-
-			vertexIndex[i].i2 = textureIndex++;
-			vertexIndex[i].i3 = normalIndex++;
+		for (uint32_t j=0; j<3; j++) {
+			uint32_t newSlot = static_cast<uint32_t>(slotNormals.size());
+			std::pair<uint32_t,bool> slot;
+			if (smoothing == 0U) {
+				flatKey.vertex = vertexIndex[j].i1;
+				auto [found, inserted] = flatSlots.try_emplace(flatKey, newSlot);
+				slot = {found->second, inserted};
+			} else {
+				auto [found, inserted] = slots.try_emplace((static_cast<uint64_t>(vertexIndex[j].i1) << 32) | smoothing, newSlot);
+				slot = {found->second, inserted};
+			}
+			if (slot.second) {
+				slotNormals.push_back(VectF3{0.0f, 0.0f, 0.0f});
+				slotVertexIndexes.push_back(vertexIndex[j].i1);
+			}
+			slotNormals[slot.first] += cornerNormals[firstCorner + j];
+			cornerSlots[firstCorner + j] = slot.first;
 		}
-		// update face with texture and normals info
-		face.setFaceType(VERTEX_TEXT_VNORM);
-		face.setIndexes(vertexIndex);
 	}
+
+	// textures: the vertex is projected on the plane of the axes its normal faces the most (box mapping)
+	VectF3 min = this->_vertexes.empty() ? VectF3{0.0f, 0.0f, 0.0f} : this->_vertexes[0];
+	VectF3 max = min;
+	for (VectF3 const& vertex : this->_vertexes) {
+		min = VectF3{std::min(min.x, vertex.x), std::min(min.y, vertex.y), std::min(min.z, vertex.z)};
+		max = VectF3{std::max(max.x, vertex.x), std::max(max.y, vertex.y), std::max(max.z, vertex.z)};
+	}
+	float extent = std::max({max.x - min.x, max.y - min.y, max.z - min.z});
+	if (extent <= 0.0f)
+		extent = 1.0f;
+
+	uint32_t textureBase = static_cast<uint32_t>(this->_textures.size());
+	uint32_t normalBase = static_cast<uint32_t>(this->_normals.size());
+	this->_textures.resize(textureBase + slotNormals.size());
+	this->_normals.resize(normalBase + slotNormals.size());
+	std::vector<size_t> slotBounds = pool.split(slotNormals.size(), SCOP_PARALLEL_MIN_FACES);
+	pool.run(slotBounds.size() - 1, [&]( size_t range ) {
+		for (size_t slot=slotBounds[range]; slot<slotBounds[range + 1]; slot++) {
+			// the weights can be smaller than F_ZERO, normalize() would leave them as they are
+			VectF3 normal = slotNormals[slot];
+			float length = getAbs(normal);
+			if (length > 0.0f)
+				normal *= 1.0f / length;
+			this->_normals[normalBase + slot] = normal;
+
+			VectF3 vertex = (this->_vertexes[slotVertexIndexes[slot]] - min) * (1.0f / extent);
+			if (fabs(normal.x) >= fabs(normal.y) and fabs(normal.x) >= fabs(normal.z))
+				this->_textures[textureBase + slot] = VectF2{vertex.z, vertex.y};
+			else if (fabs(normal.y) >= fabs(normal.z))
+				this->_textures[textureBase + slot] = VectF2{vertex.x, vertex.z};
+			else
+				this->_textures[textureBase + slot] = VectF2{vertex.x, vertex.y};
+		}
+	});
+
+	pool.run(bounds.size() - 1, [&]( size_t range ) {
+		for (size_t i=bounds[range]; i<bounds[range + 1]; i++) {
+			FaceType type = this->_faces.getFaceType(i);
+			if (type == VERTEX_TEXT_VNORM)
+				continue;
+			VectUI3* vertexIndex = this->_faces.getCorners(i);
+			size_t firstCorner = this->_faces.getFirstCorner(i);
+			// the textures and normals read from the file are kept
+			for (uint32_t j=0; j<3; j++) {
+				if (type == VERTEX or type == VERTEX_VNORM)
+					vertexIndex[j].i2 = textureBase + cornerSlots[firstCorner + j];
+				if (type == VERTEX or type == VERTEX_TEXT)
+					vertexIndex[j].i3 = normalBase + cornerSlots[firstCorner + j];
+			}
+			this->_faces.setFaceType(i, VERTEX_TEXT_VNORM);
+		}
+	});
 	this->_dataFilled = true;
 }
 
+void ParsedData::loadMaterials( void ) {
+	SCOP_ZONE("ParsedData::loadMaterials");
+	MaterialParser parser;
+	this->_materials.resize(1);
+	for (fs::path const& mtlFile : this->_tmlFiles) {
+		try {
+			parser.parse(mtlFile, this->_materials);
+		} catch (ParsingException const& error) {
+			std::cerr << "skipped material library: " << error.what() << std::endl;
+		}
+	}
+}
+
 void ParsedData::fillBuffers( void ) {
-	if (this->_faces.size() == 0)
+	SCOP_ZONE("ParsedData::fillBuffers");
+	if (this->_faces.empty())
 		return this->fillVBOnoFaces();
 
-	// maps the unique vertex-texture-normal and their indexes
-	std::unordered_map<SerializedVertex,uint32_t,VectorByteHash,VectorByteEqual> uniqueData;
 	const uint32_t 			vertexSize = VBO_STRIDE / sizeof(float); // 11, see header
 	uint32_t				uniqueIndex = 0, indexColor = 0;
-	std::vector<float>		vbo;
-	std::vector<uint32_t>	ebo;
-	// allocate only once, maximal size is known, final size <= maximal size (some vertex are removed if duplicated)
-	vbo.resize(this->_faces.size() * 3 * vertexSize);
-	// allocate only once, size is known
-	ebo.reserve(this->_faces.size() * 3);
-	float* currentVertex = vbo.data();
+	// allocate only once, maximal size is known, final size <= maximal size (some vertex are removed if duplicated):
+	// the unique vertexes are written in place, left uninitialized until then, and the VBO is shrunk at the end
+	size_t nCorners = this->_faces.getAllCorners().size();
+	std::unique_ptr<std::byte[]> vboData(new std::byte[nCorners * VBO_STRIDE]);
+	// every corner writes one index: the EBO is filled in place
+	std::unique_ptr<std::byte[]> eboData(new std::byte[nCorners * EBO_STRIDE]);
+	uint32_t* ebo = reinterpret_cast<uint32_t*>(eboData.get());
+	float* currentVertex = reinterpret_cast<float*>(vboData.get());
+	// the unique vertex-texture-normal already in the VBO and their indexes
+	VertexTable uniqueData(nCorners, currentVertex, vertexSize);
 
 	std::array<VectF3, 3> colors{
 		VectF3{randomFloat(), randomFloat(), randomFloat()},
@@ -204,31 +419,105 @@ void ParsedData::fillBuffers( void ) {
 		VectF3{randomFloat(), randomFloat(), randomFloat()}
 	};
 
-	for (Face const& face : this->_faces) {
-		for (VectUI3 const& vertexIndex : face.getIndexes()) {
-			SerializedVertex serializedVertex = this->_serializeVertex(vertexIndex, face.getFaceType());
-			if (uniqueData.count(serializedVertex) == 0) {
+	std::vector<DrawRange> ranges;
+	for (size_t i : this->_sortFacesByMaterial(ranges)) {
+		FaceType faceType = this->_faces.getFaceType(i);
+		VectUI3 const* corners = this->_faces.getCorners(i);
+		for (uint32_t j=0; j<this->_faces.getCornersCount(i); j++) {
+			SerializedVertex serializedVertex = this->_serializeVertex(corners[j], faceType);
+			auto [index, isUnique] = uniqueData.insert(serializedVertex, uniqueIndex);
+			if (isUnique) {
 				// vertex is unique, insert it inside VBO
-				uniqueData[serializedVertex] = uniqueIndex++;
+				uniqueIndex++;
 				std::memcpy(currentVertex, serializedVertex.data(), serializedVertex.size());
 				currentVertex += serializedVertex.size() / sizeof(float);
 				std::memcpy(currentVertex, &colors[indexColor++ % 3], sizeof(VectF3));
 				currentVertex += sizeof(VectF3) / sizeof(float);
 			}
-			ebo.push_back(uniqueData[serializedVertex]);
+			*ebo++ = index;
 		}
 	}
 	this->_VBOdata = std::make_shared<VBO>();
 	this->_VBOdata->size = uniqueIndex;
 	this->_VBOdata->stride = VBO_STRIDE;
-	this->_VBOdata->data = std::make_unique<float[]>(uniqueIndex * vertexSize);
-	std::move(vbo.data(), vbo.data() + uniqueIndex * vertexSize, this->_VBOdata->data.get());
+	if (uniqueIndex < nCorners) {
+		this->_VBOdata->data = std::unique_ptr<std::byte[]>(new std::byte[uniqueIndex * VBO_STRIDE]);
+		std::memcpy(this->_VBOdata->data.get(), vboData.get(), uniqueIndex * VBO_STRIDE);
+	} else
+		this->_VBOdata->data = std::move(vboData);
 
 	this->_EBOdata = std::make_shared<EBO>();
-	this->_EBOdata->size = ebo.size();
+	this->_EBOdata->size = static_cast<uint32_t>(nCorners);
 	this->_EBOdata->stride = EBO_STRIDE;
-	this->_EBOdata->data = std::make_unique<uint32_t[]>(ebo.size());
-	std::move(ebo.data(), ebo.data() + ebo.size(), this->_EBOdata->data.get());
+	// every corner has a uv and a normal by now
+	this->_EBOdata->type = VERTEX_TEXT_VNORM;
+	this->_EBOdata->ranges = std::move(ranges);
+	this->_EBOdata->data = std::move(eboData);
+}
+
+std::pair<float,float> ParsedData::optimizeBuffers( void ) {
+	SCOP_ZONE("ParsedData::optimizeBuffers");
+	if (!this->_VBOdata or !this->_EBOdata)
+		throw ParsingException("Buffers not initialized, call .fillBuffers()");
+	else if (this->_VBOdata->format != VERTEX_FLOAT or this->_EBOdata->stride != EBO_STRIDE)
+		throw ParsingException("Buffers already compacted, call .optimizeBuffers() before .compactBuffers()");
+
+	uint32_t* indexes = reinterpret_cast<uint32_t*>(this->_EBOdata->data.get());
+	uint32_t nIndexes = this->_EBOdata->size;
+	float before = computeACMR(indexes, nIndexes);
+	// files already in strip order can do better than the heuristic, they are kept as they are
+	std::vector<uint32_t> original(indexes, indexes + nIndexes);
+	// triangles don't move out of their material
+	for (DrawRange const& range : this->_EBOdata->ranges)
+		optimizeVertexCache(indexes + range.first, range.count, this->_VBOdata->size);
+	float after = computeACMR(indexes, nIndexes);
+	if (after > before) {
+		std::copy(original.cbegin(), original.cend(), indexes);
+		after = before;
+	}
+	reorderVertexesByFirstUse(reinterpret_cast<float*>(this->_VBOdata->data.get()), this->_VBOdata->size, this->_VBOdata->stride / sizeof(float), indexes, nIndexes);
+	return {before, after};
+}
+
+void ParsedData::compactBuffers( bool packVertexes ) {
+	SCOP_ZONE("ParsedData::compactBuffers");
+	if (!this->_VBOdata)
+		throw ParsingException("VBO not initialized, call .fillBuffers()");
+
+	// every index fits in 16 bits
+	if (this->_EBOdata and this->_EBOdata->stride == EBO_STRIDE and this->_VBOdata->size <= UINT16_MAX + 1U) {
+		uint32_t const* indexes = reinterpret_cast<uint32_t const*>(this->_EBOdata->data.get());
+		std::unique_ptr<std::byte[]> shortData = std::make_unique<std::byte[]>(this->_EBOdata->size * EBO_SHORT_STRIDE);
+		uint16_t* shortIndexes = reinterpret_cast<uint16_t*>(shortData.get());
+		for (uint32_t i=0; i<this->_EBOdata->size; i++)
+			shortIndexes[i] = static_cast<uint16_t>(indexes[i]);
+		this->_EBOdata->data = std::move(shortData);
+		this->_EBOdata->stride = EBO_SHORT_STRIDE;
+	}
+
+	if (packVertexes and this->_VBOdata->format == VERTEX_FLOAT) {
+		float const* vertexes = reinterpret_cast<float const*>(this->_VBOdata->data.get());
+		std::unique_ptr<std::byte[]> packedData = std::make_unique<std::byte[]>(this->_VBOdata->size * VBO_PACKED_STRIDE);
+		std::byte* packed = packedData.get();
+		for (uint32_t i=0; i<this->_VBOdata->size; i++, vertexes += VBO_STRIDE / sizeof(float)) {
+			// same order as the float layout: vertex, texture, normal, color
+			std::array<uint16_t,2> texture{toHalfFloat(vertexes[3]), toHalfFloat(vertexes[4])};
+			uint32_t normal = toPackedNormal(VectF3{vertexes[5], vertexes[6], vertexes[7]});
+			std::array<uint8_t,4> color = toPackedColor(VectF3{vertexes[8], vertexes[9], vertexes[10]});
+			std::memcpy(packed, vertexes, sizeof(VectF3));
+			packed += sizeof(VectF3);
+			std::memcpy(packed, texture.data(), sizeof(texture));
+			packed += sizeof(texture);
+			std::memcpy(packed, &normal, sizeof(normal));
+			packed += sizeof(normal);
+			std::memcpy(packed, color.data(), sizeof(color));
+			packed += sizeof(color);
+		}
+		this->_VBOdata->data = std::move(packedData);
+		this->_VBOdata->stride = VBO_PACKED_STRIDE;
+		this->_VBOdata->format = VERTEX_PACKED;
+	}
+	this->_VBOdata->computeBounds();
 }
 
 void ParsedData::fillVBOnoFaces( void ) {
@@ -238,7 +527,7 @@ void ParsedData::fillVBOnoFaces( void ) {
 	std::shared_ptr<VBO> vbo = std::make_shared<VBO>();
 	vbo->size = std::max({this->_vertexes.size(), this->_textures.size(), this->_normals.size()});
 	vbo->stride = VBO_STRIDE;
-	vbo->data = std::make_unique<float[]>(vbo->size * vbo->stride / sizeof(float));
+	vbo->data = std::make_unique<std::byte[]>(vbo->size * vbo->stride);
 
 	uint32_t indexColor = 0;
 	std::array<VectF3, 3> colors{
@@ -247,7 +536,7 @@ void ParsedData::fillVBOnoFaces( void ) {
 		VectF3{randomFloat(), randomFloat(), randomFloat()}
 	};
 
-	float* vboPtr = vbo->data.get();
+	float* vboPtr = reinterpret_cast<float*>(vbo->data.get());
 	for (uint32_t i=0; i<vbo->size; i++) {
 		VectUI3 index{i, i, i};
 		FaceType type = VERTEX;
@@ -267,67 +556,58 @@ void ParsedData::fillVBOnoFaces( void ) {
 	this->_VBOdata = std::move(vbo);
 }
 
-std::vector<VectUI3> ParsedData::_spawnTriangle(std::list<std::pair<VectUI3,VectF2>>& vertexes, std::list<VectF2>& convexVertexes, std::list<VectF2>& earVertexes, std::list<VectF2>& reflexVertexes ) const noexcept {
-	std::list<std::pair<VectUI3,VectF2>>::const_iterator curr = vertexes.cbegin();
-	// find the vertex which is an ear
-	while (std::find(earVertexes.cbegin(), earVertexes.cend(), (*curr).second) == earVertexes.cend())
-		curr = std::next(curr);
-
-	earVertexes.erase(earVertexes.cbegin());
-
-	std::list<std::pair<VectUI3,VectF2>>::const_iterator prev = std::prev(curr);
-	if (curr == vertexes.cbegin())
-		prev = std::prev(vertexes.cend());
-	std::list<std::pair<VectUI3,VectF2>>::const_iterator post = std::next(curr);
-	if (post == vertexes.cend())
-		post = vertexes.cbegin();
-
-	// if v(i +- 1) is convex check if becomes an ear
-	if (std::find(convexVertexes.cbegin(), convexVertexes.cend(), (*prev).second) != convexVertexes.cend()) {
-		if (this->_isEar(prev, vertexes) == true)
-			earVertexes.push_back((*prev).second);
-	}
-	if (std::find(convexVertexes.cbegin(), convexVertexes.cend(), (*post).second) != convexVertexes.cend()) {
-		if (this->_isEar(post, vertexes) == true)
-			earVertexes.push_back((*post).second);
-	}
-	// if v(i +- 1) is an ear check if it remains an ear
-	if (std::find(earVertexes.cbegin(), earVertexes.cend(), (*prev).second) != earVertexes.cend()) {
-		if (this->_isEar(prev, vertexes) == false)
-			earVertexes.remove((*prev).second);
-	}
-	if (std::find(earVertexes.cbegin(), earVertexes.cend(), (*post).second) != earVertexes.cend()) {
-		if (this->_isEar(prev, vertexes) == false)
-			earVertexes.remove((*post).second);
+std::vector<size_t> ParsedData::_sortFacesByMaterial( std::vector<DrawRange>& ranges ) const {
+	// material of every name of the store, names that aren't a loaded material get the default one
+	std::unordered_map<std::string_view,uint32_t> materialIds;
+	for (uint32_t i=this->_materials.size() - 1; i>0; i--)
+		materialIds[this->_materials[i].name] = i;		// the first of the libraries wins
+	StringTable const& names = this->_faces.getNames();
+	std::vector<uint32_t> nameToMaterial(names.size(), 0U);
+	for (uint32_t i=1; i<names.size(); i++) {
+		auto it = materialIds.find(names.getName(i));
+		if (it != materialIds.end())
+			nameToMaterial[i] = it->second;
 	}
-	// if v(i +- 1) is reflex check if it becomes convex or even an ear
-	if (std::find(reflexVertexes.cbegin(), reflexVertexes.cend(), (*prev).second) != reflexVertexes.cend()) {
-		if (this->_isConvex(prev, vertexes) == true) {
-			reflexVertexes.remove((*prev).second);
-			convexVertexes.push_back((*prev).second);
-			if (this->_isEar(prev, vertexes) == true)
-				earVertexes.push_back((*post).second);
-		}
+
+	// materials with the same texture one after the other, so the texture is bound once
+	std::vector<uint32_t> drawOrder(this->_materials.size());
+	for (uint32_t i=0; i<drawOrder.size(); i++)
+		drawOrder[i] = i;
+	std::stable_sort(drawOrder.begin(), drawOrder.end(), [this]( uint32_t a, uint32_t b ) {
+		return this->_materials[a].diffuseMap < this->_materials[b].diffuseMap;
+	});
+
+	// counting sort: faces of a material keep the order of the file
+	std::vector<size_t> counts(this->_materials.size(), 0U);
+	std::vector<uint32_t> corners(this->_materials.size(), 0U);
+	for (size_t i=0; i<this->_faces.size(); i++) {
+		uint32_t material = nameToMaterial[this->_faces.getAttributes(i).material];
+		counts[material]++;
+		corners[material] += this->_faces.getCornersCount(i);
 	}
-	if (std::find(reflexVertexes.cbegin(), reflexVertexes.cend(), (*post).second) != reflexVertexes.cend()) {
-		if (this->_isConvex(post, vertexes) == true) {
-			reflexVertexes.remove((*post).second);
-			convexVertexes.push_back((*post).second);
-			if (this->_isEar(post, vertexes) == true)
-				earVertexes.push_back((*post).second);
-		}
+	std::vector<size_t> starts(this->_materials.size(), 0U);
+	size_t start = 0U;
+	uint32_t firstIndex = 0U;
+	ranges.clear();
+	for (uint32_t material : drawOrder) {
+		starts[material] = start;
+		if (counts[material] > 0)
+			ranges.push_back(DrawRange{material, firstIndex, corners[material]});
+		start += counts[material];
+		firstIndex += corners[material];
 	}
-
-	vertexes.erase(curr);
-	return std::vector<VectUI3>{(*prev).first, (*curr).first, (*post).first};
+	std::vector<size_t> order(this->_faces.size());
+	for (size_t i=0; i<this->_faces.size(); i++)
+		order[starts[nameToMaterial[this->_faces.getAttributes(i).material]]++] = i;
+	return order;
 }
 
-std::list<std::pair<VectUI3,VectF2>> ParsedData::_create2Dvertexes( std::vector<VectUI3> const& indexList ) const noexcept {
+void ParsedData::_projectPolygon( VectUI3 const* indexList, uint32_t nIndexes, std::vector<VectF2>& polygon ) const noexcept {
 	// Newell algorithm to find the normal of a plane
 	float nx = 0.0f, ny = 0.0f, nz = 0.0f;
-	for(uint32_t i=0; i < indexList.size(); i++) {
+	for(uint32_t i=0; i < nIndexes; i++) {
 		VectF3 current = this->_vertexes[indexList[i].i1];
-		VectF3 next = this->_vertexes[indexList[(i + 1) % indexList.size()].i1];
+		VectF3 next = this->_vertexes[indexList[(i + 1) % nIndexes].i1];
 		nx += (current.y - next.y) * (current.z + next.z);
 		ny += (current.z - next.z) * (current.x + next.x);
 		nz += (current.x - next.x) * (current.y + next.y);
@@ -343,45 +623,27 @@ std::list<std::pair<VectUI3,VectF2>> ParsedData::_create2Dvertexes( std::vector<
 	v = normal ^ u;
 
 	VectF3 p0 = this->_vertexes[indexList[0].i1];
-	std::list<std::pair<VectUI3,VectF2>> vertexes;
-	for (auto const& faceIndex : indexList) {
-		VectF3 piOriginp0 = this->_vertexes[faceIndex.i1] - p0;
-		VectF2 projectedPi = VectF2{piOriginp0 * u, piOriginp0 * v};
-		vertexes.push_back(std::pair<VectUI3,VectF2>(faceIndex, projectedPi));
-	}
-	return vertexes;
-}
-
-bool ParsedData::_isConvex(std::list<std::pair<VectUI3,VectF2>>::const_iterator const& curr, std::list<std::pair<VectUI3,VectF2>> const& vertexes) const noexcept {
-	std::list<std::pair<VectUI3,VectF2>>::const_iterator prev = std::prev(curr);
-	if (curr == vertexes.cbegin())
-		prev = std::prev(vertexes.cend());
-	std::list<std::pair<VectUI3,VectF2>>::const_iterator post = std::next(curr);
-	if (post == vertexes.cend())
-		post = vertexes.cbegin();
-
-	return width((*prev).second, (*curr).second, (*post).second) < M_PI;
-}
-
-bool ParsedData::_isEar(std::list<std::pair<VectUI3,VectF2>>::const_iterator const& curr, std::list<std::pair<VectUI3,VectF2>> const& vertexes) const noexcept {
-	std::list<std::pair<VectUI3,VectF2>>::const_iterator pre = std::prev(curr);
-	if (curr == vertexes.cbegin())
-		pre = std::prev(vertexes.cend());
-	std::list<std::pair<VectUI3,VectF2>>::const_iterator post = std::next(curr);
-	if (post == vertexes.cend())
-		post = vertexes.cbegin();
-	// 3 consecutives vertexes form an ear if no other vertex is contained inside the triangle
-	for (auto check = std::next(post); check != pre; ++check) {
-		if (check == vertexes.cend()) {
-			check = vertexes.cbegin();
-			if (check == pre)
-				break;
-		}
-		if (triangleContainmentTest((*pre).second, (*curr).second, (*post).second, (*check).second) == true)
-			return false;
+	polygon.clear();
+	for (uint32_t i=0; i < nIndexes; i++) {
+		VectF3 piOriginp0 = this->_vertexes[indexList[i].i1] - p0;
+		polygon.push_back(VectF2{piOriginp0 * u, piOriginp0 * v});
 	}
-	return true;
+}
 
+void ParsedData::_weightCornerNormals( VectUI3 const* vertexIndex, VectF3* cornerNormals ) const noexcept {
+	// the normal of the triangle, long as twice its area, weighted at every corner by the angle of the corner:
+	// big faces count more and a vertex isn't pulled towards the side split in more triangles
+	std::array<VectF3, 3> triangle{this->_vertexes[vertexIndex[0].i1], this->_vertexes[vertexIndex[1].i1], this->_vertexes[vertexIndex[2].i1]};
+	VectF3 normal = getNormal(triangle, false);
+	for (uint32_t j=0; j<3; j++) {
+		VectF3 edgeNext = triangle[(j + 1) % 3] - triangle[j];
+		VectF3 edgePrev = triangle[(j + 2) % 3] - triangle[j];
+		float lengths = getAbs(edgeNext) * getAbs(edgePrev);
+		float angle = 0.0f;
+		if (lengths > 0.0f)
+			angle = acosf(std::clamp((edgeNext * edgePrev) / lengths, -1.0f, 1.0f));
+		cornerNormals[j] = normal * angle;
+	}
 }
 
 SerializedVertex ParsedData::_serializeVertex( VectUI3 const& index, FaceType faceType ) const {
@@ -417,18 +679,27 @@ SerializedVertex ParsedData::_serializeVertex( VectUI3 const& index, FaceType fa
 
 std::ostream& operator<<( std::ostream& os, VBO const& data) {
 	for (uint32_t i=0; i < data.size; i++) {
-		for (uint32_t j=0; j < data.stride / sizeof(float); j++)
-			os << data.getData()[i * data.stride / sizeof(float) + j] << " ";
+		std::byte const* vertex = data.getData() + static_cast<size_t>(i) * data.stride;
+		// packed vertexes: the float vertex, then the packed words in hexadecimal
+		uint32_t nFloats = data.format == VERTEX_PACKED ? 3 : data.stride / sizeof(float);
+		for (uint32_t j=0; j < data.stride / sizeof(float); j++) {
+			float value;
+			uint32_t word;
+			std::memcpy(&value, vertex + j * sizeof(float), sizeof(float));
+			std::memcpy(&word, vertex + j * sizeof(float), sizeof(uint32_t));
+			if (j < nFloats)
+				os << value << " ";
+			else
+				os << std::hex << word << std::dec << " ";
+		}
 		os << std::endl;
 	}
 	return os;
 }
 
 std::ostream& operator<<(std::ostream& os, EBO const& data) {
-	uint32_t const* indexes = data.getData();
-
 	for (uint32_t i=0; i<data.size; i++)
-		os << *(indexes + i) << std::endl;
+		os << data.getIndex(i) << std::endl;
 	return os;
 }
 
@@ -443,8 +714,8 @@ std::ostream& operator<<(std::ostream& os, ParsedData const& obj) {
 		os << "vn: " << vertexNorm << std::endl;
 	for (VectF3 const& vertexParam : obj.getParamSpaceVertices())
 		os << "vp: " << vertexParam << std::endl;
-	for (Face const& face : obj.getFaces())
-		os << "f: " << face << std::endl;
+	for (size_t i=0; i<obj.getFaces().size(); i++)
+		os << "f: " << obj.getFaces()[i] << std::endl;
 	for (Line const& line : obj.getLines())
 		os << "l: " << line << std::endl;
 	return os;
@@ -0,0 +1,232 @@
+#include <iterator>
+#include <algorithm>
+
+#include "faceStore.hpp"
+
+
+std::string	faceToString( FaceType face ) {
+	switch (face) {
+		case VERTEX:
+			return "VERTEX";
+		case VERTEX_TEXT:
+			return "VERTEX_TEXT";
+		case VERTEX_VNORM:
+			return "VERTEX_VNORM";
+		case VERTEX_TEXT_VNORM:
+			return "VERTEX_TEXT_VNORM";
+		default:
+			return "[invalid value: " + std::to_string(face) + "]";
+	}
+}
+
+
+uint32_t StringTable::intern( std::string_view name ) {
+	std::string key(name);
+	auto it = this->_ids.find(key);
+	if (it != this->_ids.cend())
+		return it->second;
+
+	uint32_t id = static_cast<uint32_t>(this->_names.size());
+	this->_names.push_back(key);
+	this->_ids.emplace(std::move(key), id);
+	return id;
+}
+
+std::string const& StringTable::getName( uint32_t id ) const noexcept {
+	return this->_names[id];
+}
+
+size_t StringTable::size( void ) const noexcept {
+	return this->_names.size();
+}
+
+
+FaceType Face::getFaceType( void ) const noexcept {
+	return this->_store.getFaceType(this->_index);
+}
+
+uint32_t Face::size( void ) const noexcept {
+	return this->_store.getCornersCount(this->_index);
+}
+
+VectUI3 const* Face::begin( void ) const noexcept {
+	return this->_store.getCorners(this->_index);
+}
+
+VectUI3 const* Face::end( void ) const noexcept {
+	return this->_store.getCorners(this->_index) + this->size();
+}
+
+std::string const& Face::getObject( void ) const noexcept {
+	return this->_store.getNames().getName(this->_store.getAttributes(this->_index).object);
+}
+
+std::string const& Face::getGroup( void ) const noexcept {
+	return this->_store.getNames().getName(this->_store.getAttributes(this->_index).group);
+}
+
+std::string const& Face::getMaterial( void ) const noexcept {
+	return this->_store.getNames().getName(this->_store.getAttributes(this->_index).material);
+}
+
+uint32_t Face::getSmoothing( void ) const noexcept {
+	return this->_store.getAttributes(this->_index).smoothing;
+}
+
+
+void FaceStore::reserve( size_t faces, size_t corners ) {
+	this->_corners.reserve(corners);
+	this->_offsets.reserve(faces + 1);
+	this->_types.reserve(faces);
+	this->_objects.reserve(faces);
+	this->_groups.reserve(faces);
+	this->_materials.reserve(faces);
+	this->_smoothings.reserve(faces);
+}
+
+void FaceStore::resize( size_t faces, uint32_t cornersPerFace ) {
+	this->_corners.assign(faces * cornersPerFace, VectUI3{0U, 0U, 0U});
+	this->_offsets.resize(faces + 1);
+	for (size_t i=0; i<=faces; i++)
+		this->_offsets[i] = static_cast<uint32_t>(i * cornersPerFace);
+	this->_types.assign(faces, VERTEX);
+	this->_objects.assign(faces, 0U);
+	this->_groups.assign(faces, 0U);
+	this->_materials.assign(faces, 0U);
+	this->_smoothings.assign(faces, 0U);
+}
+
+void FaceStore::push( FaceType type, VectUI3 const* corners, uint32_t nCorners, FaceAttributes const& attributes ) {
+	this->_corners.insert(this->_corners.end(), corners, corners + nCorners);
+	this->_offsets.push_back(static_cast<uint32_t>(this->_corners.size()));
+	this->_types.push_back(type);
+	this->_objects.push_back(attributes.object);
+	this->_groups.push_back(attributes.group);
+	this->_materials.push_back(attributes.material);
+	this->_smoothings.push_back(attributes.smoothing);
+}
+
+void FaceStore::set( size_t index, FaceType type, VectUI3 const* corners, FaceAttributes const& attributes ) noexcept {
+	std::copy(corners, corners + this->getCornersCount(index), this->getCorners(index));
+	this->_types[index] = type;
+	this->setAttributes(index, attributes);
+}
+
+void FaceStore::append( FaceStore const& other ) {
+	// names of the other store are interned in this one, then its ids are translated
+	std::vector<uint32_t> newIds(other._names.size());
+	for (uint32_t id=0; id<other._names.size(); id++)
+		newIds[id] = this->_names.intern(other._names.getName(id));
+
+	uint32_t cornersBase = static_cast<uint32_t>(this->_corners.size());
+	this->_corners.insert(this->_corners.end(), other._corners.cbegin(), other._corners.cend());
+	for (auto it = std::next(other._offsets.cbegin()); it != other._offsets.cend(); it++)
+		this->_offsets.push_back(cornersBase + *it);
+	this->_types.insert(this->_types.end(), other._types.cbegin(), other._types.cend());
+	for (size_t i=0; i<other.size(); i++) {
+		this->_objects.push_back(newIds[other._objects[i]]);
+		this->_groups.push_back(newIds[other._groups[i]]);
+		this->_materials.push_back(newIds[other._materials[i]]);
+	}
+	this->_smoothings.insert(this->_smoothings.end(), other._smoothings.cbegin(), other._smoothings.cend());
+}
+
+size_t FaceStore::size( void ) const noexcept {
+	return this->_types.size();
+}
+
+bool FaceStore::empty( void ) const noexcept {
+	return this->_types.empty();
+}
+
+Face FaceStore::operator[]( size_t index ) const noexcept {
+	return Face(*this, index);
+}
+
+FaceType FaceStore::getFaceType( size_t index ) const noexcept {
+	return this->_types[index];
+}
+
+void FaceStore::setFaceType( size_t index, FaceType newType ) noexcept {
+	this->_types[index] = newType;
+}
+
+uint32_t FaceStore::getCornersCount( size_t index ) const noexcept {
+	return this->_offsets[index + 1] - this->_offsets[index];
+}
+
+size_t FaceStore::getFirstCorner( size_t index ) const noexcept {
+	// valid for index == size() too, it's the number of corners
+	return this->_offsets[index];
+}
+
+VectUI3 const* FaceStore::getCorners( size_t index ) const noexcept {
+	return this->_corners.data() + this->_offsets[index];
+}
+
+VectUI3* FaceStore::getCorners( size_t index ) noexcept {
+	return this->_corners.data() + this->_offsets[index];
+}
+
+std::vector<VectUI3> const& FaceStore::getAllCorners( void ) const noexcept {
+	return this->_corners;
+}
+
+FaceAttributes FaceStore::getAttributes( size_t index ) const noexcept {
+	return FaceAttributes{this->_objects[index], this->_groups[index], this->_materials[index], this->_smoothings[index]};
+}
+
+void FaceStore::setAttributes( size_t index, FaceAttributes const& attributes ) noexcept {
+	this->_objects[index] = attributes.object;
+	this->_groups[index] = attributes.group;
+	this->_materials[index] = attributes.material;
+	this->_smoothings[index] = attributes.smoothing;
+}
+
+StringTable const& FaceStore::getNames( void ) const noexcept {
+	return this->_names;
+}
+
+StringTable& FaceStore::getNames( void ) noexcept {
+	return this->_names;
+}
+
+
+std::ostream& operator<<(std::ostream& os, FaceType type) {
+	os << faceToString(type);
+	return os;
+}
+
+std::ostream& operator<<(std::ostream& os, Face const& obj) {
+	switch (obj.getFaceType()) {
+		case (VERTEX):
+			for (VectUI3 const& faceIndex : obj) {
+				os << faceIndex.i1 + 1 << " ";
+			}
+			break;
+		case (VERTEX_TEXT):
+			for (VectUI3 const& faceIndex : obj) {
+				os << faceIndex.i1 + 1 << "/" << faceIndex.i2 + 1 << " ";
+			}
+			break;
+		case (VERTEX_VNORM):
+			for (VectUI3 const& faceIndex : obj) {
+				os << faceIndex.i1 + 1 << "//" << faceIndex.i3 + 1 << " ";
+			}
+			break;
+		case (VERTEX_TEXT_VNORM):
+			for (VectUI3 const& faceIndex : obj) {
+				os << faceIndex.i1 + 1 << "/" << faceIndex.i2 + 1 << "/" << faceIndex.i3 + 1 << " ";
+			}
+			break;
+	}
+	if (obj.getObject().length() > 0)
+		os << "|object: " << obj.getObject() << "|";
+	if (obj.getGroup().length() > 0)
+		os << "|group: " << obj.getGroup() << "|";
+	if (obj.getMaterial().length() > 0)
+		os << "|material: " << obj.getMaterial() << "|";
+	if (obj.getSmoothing() != 0)
+		os << "|smoothing: " << obj.getSmoothing() << "|";
+	return os;
+}
@@ -0,0 +1,285 @@
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef SCOP_ZSTD
+# include <zstd.h>
+#endif
+
+#include "inputStream.hpp"
+#include "exception.hpp"
+#include "profiler.hpp"
+
+
+// bytes read from the file at a time, compressed
+static constexpr size_t INPUT_READ_SIZE = 1 << 18;
+
+static Compression compressionFromMagic( char const* bytes, size_t size ) noexcept {
+	unsigned char const* magic = reinterpret_cast<unsigned char const*>(bytes);
+	if (size >= 2 and magic[0] == 0x1f and magic[1] == 0x8b)
+		return Compression::GZIP;
+	else if (size >= 4 and magic[0] == 0x28 and magic[1] == 0xb5 and magic[2] == 0x2f and magic[3] == 0xfd)
+		return Compression::ZSTD;
+	return Compression::NONE;
+}
+
+Compression detectCompression( std::string const& fileName ) {
+	int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return Compression::NONE;
+	std::array<char,4> magic{};
+	ssize_t size = read(fd, magic.data(), magic.size());
+	close(fd);
+	return compressionFromMagic(magic.data(), size > 0 ? static_cast<size_t>(size) : 0U);
+}
+
+InputStream::InputStream( std::string const& fileName ) : _fileName(fileName), _input(INPUT_READ_SIZE) {
+	if (fileName == "-")
+		this->_fd = STDIN_FILENO;
+	else if ((this->_fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC)) == -1)
+		throw ParsingException("Error while opening file: " + fileName);
+
+	try {
+		// stdin can't be read twice: the magic number stays in the input buffer
+		while (this->_inputEnd < 4 and this->_endOfFile == false)
+			this->_fillInput();
+		this->_compression = compressionFromMagic(this->_input.data(), this->_inputEnd);
+		if (this->_compression == Compression::GZIP) {
+			this->_gzip = std::make_unique<z_stream>();
+			std::memset(this->_gzip.get(), 0, sizeof(z_stream));
+			// 16: gzip header and trailer
+			if (inflateInit2(this->_gzip.get(), 15 + 16) != Z_OK) {
+				this->_gzip.reset();
+				throw ParsingException("Couldn't start gzip decompression: " + fileName);
+			}
+		}
+		else if (this->_compression == Compression::ZSTD) {
+#ifdef SCOP_ZSTD
+			this->_zstd = ZSTD_createDStream();
+			if (!this->_zstd)
+				throw ParsingException("Couldn't start zstd decompression: " + fileName);
+#else
+			throw ParsingException("zstd input not supported (build with: make ZSTD=1): " + fileName);
+#endif
+		}
+	} catch (...) {
+		if (this->_fd != STDIN_FILENO)
+			close(this->_fd);
+		throw;
+	}
+}
+
+InputStream::~InputStream( void ) noexcept {
+	if (this->_gzip)
+		inflateEnd(this->_gzip.get());
+#ifdef SCOP_ZSTD
+	if (this->_zstd)
+		ZSTD_freeDStream(this->_zstd);
+#endif
+	if (this->_fd != -1 and this->_fd != STDIN_FILENO)
+		close(this->_fd);
+}
+
+size_t InputStream::read( char* buffer, size_t size ) {
+	if (this->_compression == Compression::GZIP)
+		return this->_readGzip(buffer, size);
+	else if (this->_compression == Compression::ZSTD)
+		return this->_readZstd(buffer, size);
+	return this->_readPlain(buffer, size);
+}
+
+Compression InputStream::getCompression( void ) const noexcept {
+	return this->_compression;
+}
+
+uint64_t InputStream::getReadBytes( void ) const noexcept {
+	return this->_readBytes;
+}
+
+bool InputStream::_fillInput( void ) {
+	// the bytes not consumed yet go to the front
+	if (this->_inputStart > 0) {
+		std::memmove(this->_input.data(), this->_input.data() + this->_inputStart, this->_inputEnd - this->_inputStart);
+		this->_inputEnd -= this->_inputStart;
+		this->_inputStart = 0;
+	}
+	ssize_t size;
+	do {
+		size = ::read(this->_fd, this->_input.data() + this->_inputEnd, this->_input.size() - this->_inputEnd);
+	} while (size == -1 and errno == EINTR);
+	if (size == -1)
+		throw ParsingException("Error while reading file: " + this->_fileName + ": " + std::strerror(errno));
+	else if (size == 0) {
+		this->_endOfFile = true;
+		return false;
+	}
+	this->_inputEnd += static_cast<size_t>(size);
+	this->_readBytes += static_cast<uint64_t>(size);
+	return true;
+}
+
+size_t InputStream::_readPlain( char* buffer, size_t size ) {
+	size_t produced = std::min(size, this->_inputEnd - this->_inputStart);
+	std::memcpy(buffer, this->_input.data() + this->_inputStart, produced);
+	this->_inputStart += produced;
+	// the rest goes straight to the caller's buffer
+	while (produced < size and this->_endOfFile == false) {
+		ssize_t read;
+		do {
+			read = ::read(this->_fd, buffer + produced, size - produced);
+		} while (read == -1 and errno == EINTR);
+		if (read == -1)
+			throw ParsingException("Error while reading file: " + this->_fileName + ": " + std::strerror(errno));
+		else if (read == 0)
+			this->_endOfFile = true;
+		produced += static_cast<size_t>(read);
+		this->_readBytes += static_cast<uint64_t>(read);
+	}
+	return produced;
+}
+
+size_t InputStream::_readGzip( char* buffer, size_t size ) {
+	z_stream& stream = *this->_gzip;
+	size_t produced = 0;
+	while (produced < size and this->_endOfStream == false) {
+		if (this->_inputStart == this->_inputEnd and this->_endOfFile == false)
+			this->_fillInput();
+		size_t available = this->_inputEnd - this->_inputStart;
+		stream.next_in = reinterpret_cast<Bytef*>(this->_input.data() + this->_inputStart);
+		stream.avail_in = static_cast<uInt>(available);
+		stream.next_out = reinterpret_cast<Bytef*>(buffer + produced);
+		stream.avail_out = static_cast<uInt>(size - produced);
+		int result = inflate(&stream, Z_NO_FLUSH);
+		size_t consumed = available - stream.avail_in;
+		size_t written = (size - produced) - stream.avail_out;
+		this->_inputStart += consumed;
+		produced += written;
+
+		if (result == Z_STREAM_END) {
+			// gzip members can be concatenated: another one may follow
+			inflateReset(&stream);
+			if (this->_inputStart == this->_inputEnd and (this->_endOfFile or this->_fillInput() == false))
+				this->_endOfStream = true;
+		}
+		else if (result == Z_BUF_ERROR or (consumed == 0 and written == 0)) {
+			if (this->_endOfFile and this->_inputStart == this->_inputEnd)
+				throw ParsingException("Truncated gzip file: " + this->_fileName);
+		}
+		else if (result != Z_OK)
+			throw ParsingException("Corrupted gzip file: " + this->_fileName + (stream.msg ? std::string(": ") + stream.msg : std::string()));
+	}
+	return produced;
+}
+
+size_t InputStream::_readZstd( char* buffer, size_t size ) {
+#ifdef SCOP_ZSTD
+	size_t produced = 0;
+	while (produced < size and this->_endOfStream == false) {
+		if (this->_inputStart == this->_inputEnd and this->_endOfFile == false)
+			this->_fillInput();
+		ZSTD_inBuffer input{this->_input.data() + this->_inputStart, this->_inputEnd - this->_inputStart, 0};
+		ZSTD_outBuffer output{buffer + produced, size - produced, 0};
+		size_t result = ZSTD_decompressStream(this->_zstd, &output, &input);
+		if (ZSTD_isError(result))
+			throw ParsingException("Corrupted zstd file: " + this->_fileName + ": " + ZSTD_getErrorName(result));
+		this->_inputStart += input.pos;
+		produced += output.pos;
+		// 0: the frame is over and flushed, frames can be concatenated
+		if (input.pos > 0 or output.pos > 0)
+			this->_frameDone = result == 0;
+		else if (this->_endOfFile and this->_inputStart == this->_inputEnd) {
+			if (this->_frameDone == false)
+				throw ParsingException("Truncated zstd file: " + this->_fileName);
+			this->_endOfStream = true;
+		}
+	}
+	return produced;
+#else
+	(void)buffer;
+	(void)size;
+	return 0U;
+#endif
+}
+
+
+StreamPipeline::StreamPipeline( std::string const& fileName, size_t bufferSize ) : _stream(fileName), _bufferSize(bufferSize) {
+	for (std::unique_ptr<char[]>& buffer : this->_buffers)
+		buffer.reset(new char[bufferSize]);
+	this->_reader = std::thread(&StreamPipeline::_readInput, this);
+}
+
+StreamPipeline::~StreamPipeline( void ) noexcept {
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_stop = true;
+	}
+	this->_changed.notify_all();
+	if (this->_reader.joinable())
+		this->_reader.join();
+}
+
+std::string_view StreamPipeline::next( void ) {
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	// the block read last time goes back to the reader
+	if (this->_holding) {
+		this->_full[this->_current] = false;
+		this->_current ^= 1U;
+		this->_holding = false;
+		this->_changed.notify_all();
+	}
+	this->_changed.wait(lock, [this]() { return this->_full[this->_current] or this->_done; });
+	if (this->_full[this->_current] == false) {
+		if (this->_error)
+			std::rethrow_exception(this->_error);
+		return std::string_view();
+	}
+	this->_holding = true;
+	return std::string_view(this->_buffers[this->_current].get(), this->_sizes[this->_current]);
+}
+
+Compression StreamPipeline::getCompression( void ) const noexcept {
+	return this->_stream.getCompression();
+}
+
+uint64_t StreamPipeline::getReadBytes( void ) const noexcept {
+	return this->_stream.getReadBytes();
+}
+
+void StreamPipeline::_readInput( void ) noexcept {
+	SCOP_THREAD_NAME("stream reader");
+	try {
+		for (size_t index=0; ; index^=1U) {
+			{
+				std::unique_lock<std::mutex> lock(this->_mutex);
+				this->_changed.wait(lock, [this, index]() { return this->_full[index] == false or this->_stop; });
+				if (this->_stop)
+					break;
+			}
+			// the buffer is free: filled without the lock
+			SCOP_ZONE("read block");
+			char* buffer = this->_buffers[index].get();
+			size_t size = 0, read;
+			while (size < this->_bufferSize and (read = this->_stream.read(buffer + size, this->_bufferSize - size)) > 0)
+				size += read;
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			if (size > 0) {
+				this->_sizes[index] = size;
+				this->_full[index] = true;
+			}
+			if (size < this->_bufferSize) {
+				this->_done = true;
+				this->_changed.notify_all();
+				return;
+			}
+			this->_changed.notify_all();
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_error = std::current_exception();
+	}
+	std::lock_guard<std::mutex> lock(this->_mutex);
+	this->_done = true;
+	this->_changed.notify_all();
+}
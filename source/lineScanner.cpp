@@ -0,0 +1,189 @@
+#include <cstring>
+
+#include "lineScanner.hpp"
+
+#if defined(__x86_64__) or defined(__i386__)
+# include <immintrin.h>
+# define SCOP_SCAN_X86 1
+#else
+# define SCOP_SCAN_X86 0
+#endif
+
+
+static constexpr size_t BLOCK_SIZE = 64;
+
+// 8 bytes at a time in a 64 bits word: the high bit of every byte equal to '\n' is set exactly (no borrow between bytes),
+// then the 8 high bits are gathered in the top byte by the multiplication
+static uint64_t scalarNewlineMask( char const* block ) noexcept {
+	constexpr uint64_t NEWLINES = 0x0a0a0a0a0a0a0a0aULL, LOW_BITS = 0x7f7f7f7f7f7f7f7fULL;
+	uint64_t mask = 0U;
+	for (size_t i=0; i<BLOCK_SIZE; i+=8) {
+		uint64_t word;
+		std::memcpy(&word, block + i, sizeof(uint64_t));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		word = __builtin_bswap64(word);
+#endif
+		word ^= NEWLINES;
+		uint64_t highBits = ~(((word & LOW_BITS) + LOW_BITS) | word | LOW_BITS);
+		mask |= (((highBits >> 7) * 0x0102040810204080ULL) >> 56) << i;
+	}
+	return mask;
+}
+
+#if SCOP_SCAN_X86
+__attribute__((target("sse2")))
+static uint64_t sse2NewlineMask( char const* block ) noexcept {
+	__m128i const newline = _mm_set1_epi8('\n');
+	uint64_t mask = 0U;
+	for (size_t i=0; i<BLOCK_SIZE; i+=16) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + i));
+		mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << i;
+	}
+	return mask;
+}
+
+__attribute__((target("avx2")))
+static uint64_t avx2NewlineMask( char const* block ) noexcept {
+	__m256i const newline = _mm256_set1_epi8('\n');
+	__m256i low = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block));
+	__m256i high = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block + 32));
+	uint64_t lowMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline)));
+	uint64_t highMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)));
+	return lowMask | (highMask << 32);
+}
+#endif
+
+static inline bool isSeparator( char c ) noexcept {
+	return c == ' ' or c == '\t';
+}
+
+// the directive word has to be followed by a blank, "v1 2 3" or "usemtl\r" are left to the generic path
+static ObjLine classifyLine( std::string_view line ) noexcept {
+	ObjLine result{line, std::string_view(), DIRECTIVE_OTHER};
+	size_t wordSize = 0;
+	if (line.empty() or line == "\r") {
+		result.directive = DIRECTIVE_EMPTY;
+		return result;
+	}
+	switch (line[0]) {
+		case '#':
+			result.directive = DIRECTIVE_COMMENT;
+			return result;
+		case 'v':
+			if (line.size() > 1 and isSeparator(line[1])) {
+				result.directive = DIRECTIVE_VERTEX;
+				wordSize = 1;
+			}
+			else if (line.size() > 2 and isSeparator(line[2])) {
+				wordSize = 2;
+				if (line[1] == 't')
+					result.directive = DIRECTIVE_TEXTURE;
+				else if (line[1] == 'n')
+					result.directive = DIRECTIVE_NORMAL;
+				else if (line[1] == 'p')
+					result.directive = DIRECTIVE_SPACE_VERTEX;
+			}
+			break;
+		case 'f':
+		case 'l':
+		case 'o':
+		case 'g':
+		case 's':
+			if (line.size() > 1 and isSeparator(line[1])) {
+				wordSize = 1;
+				result.directive = line[0] == 'f' ? DIRECTIVE_FACE : line[0] == 'l' ? DIRECTIVE_LINE :
+					line[0] == 'o' ? DIRECTIVE_OBJECT : line[0] == 'g' ? DIRECTIVE_GROUP : DIRECTIVE_SMOOTHING;
+			}
+			break;
+		case 'u':
+		case 'm':
+			if (line.size() > 6 and isSeparator(line[6])) {
+				wordSize = 6;
+				if (line.compare(0, 6, "usemtl") == 0)
+					result.directive = DIRECTIVE_USEMTL;
+				else if (line.compare(0, 6, "mtllib") == 0)
+					result.directive = DIRECTIVE_MTLLIB;
+			}
+			break;
+		default:
+			break;
+	}
+	if (result.directive != DIRECTIVE_OTHER)
+		result.content = line.substr(wordSize + 1);
+	return result;
+}
+
+LineScanner::LineScanner( std::string_view buffer, ScanLevel level ) noexcept : _buffer(buffer) {
+	this->_newlineMask = scalarNewlineMask;
+#if SCOP_SCAN_X86
+	if (level == SCAN_AVX2)
+		this->_newlineMask = avx2NewlineMask;
+	else if (level == SCAN_SSE2)
+		this->_newlineMask = sse2NewlineMask;
+#else
+	(void)level;
+#endif
+}
+
+size_t LineScanner::next( std::array<ObjLine,BATCH_SIZE>& batch ) noexcept {
+	size_t count = 0;
+	while (count < BATCH_SIZE) {
+		if (this->_mask == 0U) {
+			if (this->_nextBlock < this->_buffer.size()) {
+				this->_loadBlock();
+				continue;
+			}
+			// last line without '\n'
+			if (this->_lineStart < this->_buffer.size()) {
+				batch[count++] = classifyLine(this->_buffer.substr(this->_lineStart));
+				this->_lineStart = this->_buffer.size();
+			}
+			break;
+		}
+		size_t lineEnd = this->_maskBase + static_cast<size_t>(__builtin_ctzll(this->_mask));
+		this->_mask &= this->_mask - 1;
+		batch[count++] = classifyLine(this->_buffer.substr(this->_lineStart, lineEnd - this->_lineStart));
+		this->_lineStart = lineEnd + 1;
+	}
+	return count;
+}
+
+ScanLevel LineScanner::detectLevel( void ) noexcept {
+	// asked once, every chunk of the parser creates a scanner
+	static ScanLevel const level = []() {
+#if SCOP_SCAN_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return SCAN_AVX2;
+		else if (__builtin_cpu_supports("sse2"))
+			return SCAN_SSE2;
+#endif
+		return SCAN_SCALAR;
+	}();
+	return level;
+}
+
+char const* LineScanner::levelToString( ScanLevel level ) noexcept {
+	switch (level) {
+		case SCAN_AVX2:
+			return "AVX2";
+		case SCAN_SSE2:
+			return "SSE2";
+		case SCAN_SCALAR:
+			return "scalar";
+	}
+	return "unknown";
+}
+
+void LineScanner::_loadBlock( void ) noexcept {
+	this->_maskBase = this->_nextBlock;
+	this->_nextBlock += BLOCK_SIZE;
+	if (this->_maskBase + BLOCK_SIZE <= this->_buffer.size()) {
+		this->_mask = this->_newlineMask(this->_buffer.data() + this->_maskBase);
+		return;
+	}
+	// the last block is copied: the mask function always reads 64 bytes
+	std::array<char,BLOCK_SIZE> tail{};
+	std::memcpy(tail.data(), this->_buffer.data() + this->_maskBase, this->_buffer.size() - this->_maskBase);
+	this->_mask = this->_newlineMask(tail.data());
+}
@@ -3,6 +3,9 @@
 #include "exception.hpp"
 #include "scop.hpp"
 #include "argParser.hpp"
+#include "meshBaker.hpp"
+#include "meshCache.hpp"
+#include "profiler.hpp"
 
 
 int32_t main(int32_t argc, char** argv) {
@@ -13,12 +16,30 @@ int32_t main(int32_t argc, char** argv) {
 			std::cout << HOW_TO << std::endl;
 			return (EXIT_SUCCESS);
 		}
+#ifdef SCOP_PROFILE
+		// written once the app is destroyed and its threads joined, also when it fails
+		std::optional<Profiler> profiler;
+		if (options.traceFile.empty() == false)
+			profiler.emplace(options.traceFile);
+#endif
+		// headless: no window nor GL context
+		if (options.bakePath.empty() == false) {
+			MeshBaker baker(options.threads, (options.optimize ? CACHE_OPTIMIZED : 0U) | (options.packed ? CACHE_PACKED : 0U), options.useCache == false);
+			return baker.bake(options.bakePath) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
 		
 		ScopGL app{};
-		app.parseFile(options.objFile);
-		app.createWindow(options.width, options.height);
+		app.parseFile(options.objFile, options.threads, options.useCache, options.optimize, options.packed);
+		app.createWindow(options.width, options.height, options.benchFrames == 0);
 		app.initGL(options.vertexShaderFile, options.fragmentShaderFile, options.textureFile);
-		app.loop();
+		if (options.replayFile.empty() == false)
+			app.replayPath(options.replayFile);
+		if (options.recordFile.empty() == false)
+			app.recordPath(options.recordFile);
+		if (options.benchFrames > 0)
+			app.benchmark(options.benchFrames);
+		else
+			app.loop();
 
 	} catch (AppException& err) {
 		std::cerr << err.what() << std::endl;
@@ -0,0 +1,53 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mappedFile.hpp"
+#include "exception.hpp"
+
+
+MappedFile::MappedFile( std::string const& fileName ) {
+	int32_t fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw AppException("Error while opening file: " + fileName);
+
+	struct stat info;
+	if (fstat(fd, &info) == -1 or !S_ISREG(info.st_mode)) {
+		close(fd);
+		throw AppException("Error while opening file: " + fileName);
+	}
+	this->_size = static_cast<size_t>(info.st_size);
+	// mmap() refuses empty mappings, an empty file is simply an empty view
+	if (this->_size == 0) {
+		close(fd);
+		return;
+	}
+
+	void* mapping = mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		throw AppException("Error while mapping file: " + fileName);
+	// the file is always walked front to back
+	madvise(mapping, this->_size, MADV_SEQUENTIAL);
+	this->_data = static_cast<char const*>(mapping);
+}
+
+MappedFile::~MappedFile( void ) noexcept {
+	if (this->_data)
+		munmap(const_cast<char*>(this->_data), this->_size);
+}
+
+char const* MappedFile::data( void ) const noexcept {
+	return this->_data;
+}
+
+size_t MappedFile::size( void ) const noexcept {
+	return this->_size;
+}
+
+std::string_view MappedFile::view( void ) const noexcept {
+	if (!this->_data)
+		return std::string_view();
+	return std::string_view(this->_data, this->_size);
+}
@@ -0,0 +1,98 @@
+#include <memory>
+
+#include "material.hpp"
+#include "mappedFile.hpp"
+#include "numberParser.hpp"
+#include "exception.hpp"
+
+
+void MaterialParser::parse( fs::path const& mtlFile, std::vector<Material>& materials ) const {
+	std::unique_ptr<MappedFile> mappedFile;
+	try {
+		mappedFile = std::make_unique<MappedFile>(mtlFile.string());
+	}
+	catch (AppException const& error) {
+		throw ParsingException("Error while opening material library: " + mtlFile.string());
+	}
+
+	// the materials before are the default one and the ones of the other libraries
+	size_t firstMaterial = materials.size();
+	std::string_view buffer = mappedFile->view();
+	while (buffer.empty() == false) {
+		size_t endLine = buffer.find('\n');
+		std::string_view line = buffer.substr(0, endLine);
+		if (endLine == std::string_view::npos)
+			buffer = std::string_view();
+		else
+			buffer.remove_prefix(endLine + 1);
+
+		line = trimBlanks(line);
+		if (line.length() == 0 or line[0] == '#')
+			continue;
+		this->_parseDirective(line, mtlFile, materials, firstMaterial);
+	}
+}
+
+void MaterialParser::_parseDirective( std::string_view line, fs::path const& mtlFile, std::vector<Material>& materials, size_t firstMaterial ) const {
+	std::string_view lineContent = line;
+	std::string_view lineType = nextToken(lineContent);
+	lineContent = trimBlanks(lineContent);
+
+	if (lineType == "newmtl") {
+		if (lineContent.empty())
+			throw ParsingException("Material without name in: " + mtlFile.string());
+		materials.push_back(Material{});
+		materials.back().name = std::string(lineContent);
+		return;
+	}
+	// everything else describes the last material, the directives not used are skipped
+	if (lineType != "Ka" and lineType != "Kd" and lineType != "Ks" and lineType != "Ns" and lineType != "map_Kd")
+		return;
+	else if (materials.size() == firstMaterial)
+		throw ParsingException("Material directive before newmtl: " + std::string(line));
+
+	Material& material = materials.back();
+	if (lineType == "Ka")
+		material.ambient = this->_createColor(lineContent);
+	else if (lineType == "Kd")
+		material.diffuse = this->_createColor(lineContent);
+	else if (lineType == "Ks")
+		material.specular = this->_createColor(lineContent);
+	else if (lineType == "Ns")
+		material.shininess = tokenToFloat(lineContent);
+	else
+		material.diffuseMap = this->_createMap(lineContent, mtlFile);
+}
+
+VectF3 MaterialParser::_createColor( std::string_view content ) const {
+	std::string_view remaining = content;
+	std::string_view component = nextToken(remaining);
+	if (component.empty())
+		throw ParsingException("No color components provided: " + std::string(content));
+	else if (component == "spectral" or component == "xyz")
+		throw ParsingException("Color format not supported: " + std::string(content));
+
+	// a single value is a grey
+	float r = tokenToFloat(component);
+	float g = r, b = r;
+	if ((component = nextToken(remaining)).empty() == false) {
+		g = tokenToFloat(component);
+		if ((component = nextToken(remaining)).empty())
+			throw ParsingException("Not enough color components provided: " + std::string(content));
+		b = tokenToFloat(component);
+	}
+	return VectF3{r, g, b};
+}
+
+fs::path MaterialParser::_createMap( std::string_view content, fs::path const& mtlFile ) const {
+	// options (-s, -o, -bm, ...) come before the file name, the last word is the file
+	size_t start = content.find_last_of(" \t");
+	std::string_view fileName = start == std::string_view::npos ? content : content.substr(start + 1);
+	if (fileName.empty())
+		throw ParsingException("Texture map without file: " + std::string(content));
+
+	fs::path mapFile = fileName;
+	if (mapFile.is_relative())
+		mapFile = mtlFile.parent_path() / mapFile;
+	return mapFile;
+}
@@ -0,0 +1,61 @@
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <sys/resource.h>
+
+#include "memoryStats.hpp"
+
+
+static std::atomic<uint64_t> allocations{0U};
+static std::atomic<uint64_t> allocatedBytes{0U};
+
+MemoryStats getMemoryStats( void ) noexcept {
+	MemoryStats stats{allocations.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed), 0U};
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		stats.peakRss = static_cast<uint64_t>(usage.ru_maxrss) * 1024U;	// kilobytes on linux
+	return stats;
+}
+
+#ifndef __SANITIZE_ADDRESS__
+// the array and nothrow versions of the standard library call these ones
+static void* countedAlloc( size_t size, size_t alignment ) {
+	allocations.fetch_add(1U, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (size == 0)
+		size = 1;
+	void* memory = nullptr;
+	if (alignment <= alignof(std::max_align_t))
+		memory = std::malloc(size);
+	else if (posix_memalign(&memory, alignment, size) != 0)
+		memory = nullptr;
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new( size_t size ) {
+	return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new( size_t size, std::align_val_t alignment ) {
+	return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete( void* memory ) noexcept {
+	std::free(memory);
+}
+
+void operator delete( void* memory, size_t ) noexcept {
+	std::free(memory);
+}
+
+void operator delete( void* memory, std::align_val_t ) noexcept {
+	std::free(memory);
+}
+
+void operator delete( void* memory, size_t, std::align_val_t ) noexcept {
+	std::free(memory);
+}
+#endif
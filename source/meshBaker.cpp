@@ -0,0 +1,141 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#include "meshBaker.hpp"
+#include "meshCache.hpp"
+#include "parser.hpp"
+#include "data.hpp"
+#include "exception.hpp"
+#include "memoryStats.hpp"
+#include "profiler.hpp"
+
+
+static bool isObjectFile( fs::path const& file ) {
+	std::string name = file.filename().string();
+	for (std::string_view extension : {".obj", ".obj.gz", ".obj.zst", ".stl", ".ply"}) {
+		if (name.size() > extension.size() and name.compare(name.size() - extension.size(), extension.size(), extension) == 0)
+			return true;
+	}
+	return false;
+}
+
+static double toMegabytesPerSecond( uint64_t bytes, double milliseconds ) noexcept {
+	return milliseconds > 0.0 ? static_cast<double>(bytes) / 1000.0 / milliseconds : 0.0;
+}
+
+MeshBaker::MeshBaker( uint32_t threads, uint32_t flags, bool force ) : _pool(threads), _flags(flags), _force(force) {}
+
+bool MeshBaker::bake( fs::path const& path ) {
+	std::vector<fs::path> files = this->_findObjectFiles(path);
+	if (files.empty())
+		throw ParsingException("No object file to bake in: " + path.string());
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<BakeResult> results(files.size());
+	// every error is kept in its result: one broken file doesn't stop the others
+	this->_pool.run(files.size(), [&]( size_t i ) {
+		results[i] = this->_bakeFile(files[i]);
+		this->_printResult(results[i]);
+	});
+	double elapsed = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	uint64_t bytes = 0U;
+	size_t baked = 0, upToDate = 0, failed = 0;
+	for (BakeResult const& result : results) {
+		bytes += result.bytes;
+		baked += result.baked;
+		upToDate += result.upToDate;
+		failed += result.error.empty() == false;
+	}
+	std::cout << "baked " << baked << " files (" << upToDate << " up to date, " << failed << " failed), " << std::fixed <<
+		std::setprecision(1) << bytes / 1e6 << "MB in " << elapsed << "ms: " << toMegabytesPerSecond(bytes, elapsed) <<
+		"MB/s with " << this->_pool.size() << " threads" << std::defaultfloat << std::endl;
+	MemoryStats memory = getMemoryStats();
+	std::cout << "memory: " << memory.allocations << " allocations (" << memory.allocatedBytes / 1000000 << "MB), peak RSS " << memory.peakRss / 1000000 << "MB" << std::endl;
+	return failed == 0;
+}
+
+std::vector<fs::path> MeshBaker::_findObjectFiles( fs::path const& path ) const {
+	std::error_code error;
+	if (fs::is_regular_file(path, error))
+		return {path};
+	else if (fs::is_directory(path, error) == false)
+		throw ParsingException("Nothing to bake at: " + path.string());
+
+	std::vector<std::pair<uintmax_t,fs::path>> found;
+	for (fs::directory_entry const& entry : fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, error)) {
+		if (entry.is_regular_file(error) and isObjectFile(entry.path()))
+			found.emplace_back(entry.file_size(error), entry.path());
+	}
+	if (error)
+		throw ParsingException("Error while reading folder: " + path.string() + ": " + error.message());
+	// biggest files first: a big file picked last would leave the other threads idle
+	std::sort(found.begin(), found.end(), []( auto const& a, auto const& b ) {
+		return a.first != b.first ? a.first > b.first : a.second < b.second;
+	});
+	std::vector<fs::path> files;
+	for (auto& [size, file] : found)
+		files.push_back(std::move(file));
+	return files;
+}
+
+BakeResult MeshBaker::_bakeFile( fs::path const& file ) const {
+	SCOP_ZONE("MeshBaker::_bakeFile");
+	BakeResult result;
+	result.file = file;
+	auto start = std::chrono::steady_clock::now();
+	auto elapsed = [&start]() {
+		return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+	try {
+		MeshCache cache(file.string(), this->_flags);
+		std::shared_ptr<VBO> vboData;
+		std::shared_ptr<EBO> eboData;
+		std::vector<Material> materials;
+		if (this->_force == false and cache.load(vboData, eboData, materials)) {
+			result.upToDate = true;
+			result.milliseconds = elapsed();
+			return result;
+		}
+
+		FileParser parser;
+		ParsedData data = parser.parse(file.string());
+		result.bytes = parser.getInputBytes();
+		data.triangolate();
+		data.fixTrianglesOrientation();
+		data.fillTexturesAndNormals();
+		data.loadMaterials();
+		data.fillBuffers();
+		if ((this->_flags & CACHE_OPTIMIZED) and data.hasFaces())
+			data.optimizeBuffers();
+		data.compactBuffers(this->_flags & CACHE_PACKED);
+		vboData = data.getVBO();
+		if (data.hasFaces())
+			eboData = data.getEBO();
+		if (cache.save(*vboData, eboData.get(), data.getMaterials(), data.getTmlFiles()) == false)
+			throw ParsingException("Couldn't write mesh cache: " + cache.getCacheFile().string());
+		result.baked = true;
+		result.vertexes = vboData->size;
+		result.indexes = eboData ? eboData->size : 0U;
+	} catch (std::exception const& err) {
+		// parsing errors, but also filesystem errors and allocation failures of a huge file
+		result.error = err.what();
+	}
+	result.milliseconds = elapsed();
+	return result;
+}
+
+void MeshBaker::_printResult( BakeResult const& result ) {
+	std::lock_guard<std::mutex> lock(this->_printMutex);
+	if (result.error.empty() == false)
+		std::cerr << "failed " << result.file.string() << ": " << result.error << std::endl;
+	else if (result.upToDate)
+		std::cout << "up to date " << result.file.string() << " (checked in " << std::fixed << std::setprecision(1) << result.milliseconds <<
+			"ms)" << std::defaultfloat << std::endl;
+	else
+		std::cout << "baked " << result.file.string() << ": " << std::fixed << std::setprecision(1) << result.bytes / 1e6 << "MB in " <<
+			result.milliseconds << "ms (" << toMegabytesPerSecond(result.bytes, result.milliseconds) << "MB/s), " << result.vertexes <<
+			" vertexes, " << result.indexes << " indexes" << std::defaultfloat << std::endl;
+}
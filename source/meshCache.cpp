@@ -0,0 +1,287 @@
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstddef>
+#include <sys/stat.h>
+
+#include "meshCache.hpp"
+#include "mappedFile.hpp"
+#include "exception.hpp"
+#include "define.hpp"
+#include "profiler.hpp"
+
+
+static size_t alignTo8( size_t offset ) noexcept {
+	return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+static bool statFile( fs::path const& file, uint64_t& size, int64_t& mtime ) noexcept {
+	struct stat info;
+	if (stat(file.c_str(), &info) == -1 or !S_ISREG(info.st_mode))
+		return false;
+	size = static_cast<uint64_t>(info.st_size);
+	mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+	return true;
+}
+
+template <typename T>
+static void writeValue( std::string& block, T const& value ) {
+	block.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+static void writeString( std::string& block, std::string const& str ) {
+	writeValue(block, static_cast<uint32_t>(str.size()));
+	block.append(str);
+}
+
+// false if the block is too short, a broken cache
+template <typename T>
+static bool readValue( std::string_view& block, T& value ) noexcept {
+	if (block.size() < sizeof(T))
+		return false;
+	std::memcpy(&value, block.data(), sizeof(T));
+	block.remove_prefix(sizeof(T));
+	return true;
+}
+
+static bool readString( std::string_view& block, std::string& str ) {
+	uint32_t size;
+	if (readValue(block, size) == false or block.size() < size)
+		return false;
+	str.assign(block.data(), size);
+	block.remove_prefix(size);
+	return true;
+}
+
+MeshCache::MeshCache( std::string const& objFile, uint32_t flags ) : _flags(flags) {
+	this->_objFile = fs::absolute(objFile).lexically_normal();
+	this->_cacheFile = this->_objFile;
+	this->_cacheFile += SCOP_MESH_CACHE_EXTENSION;
+}
+
+bool MeshCache::load( std::shared_ptr<VBO>& vboData, std::shared_ptr<EBO>& eboData, std::vector<Material>& materials ) const {
+	SCOP_ZONE("MeshCache::load");
+	uint64_t sourceSize;
+	int64_t sourceMtime;
+	if (this->_statSource(sourceSize, sourceMtime) == false)
+		return false;
+
+	std::shared_ptr<MappedFile> cache;
+	try {
+		cache = std::make_shared<MappedFile>(this->_cacheFile.string());
+	} catch (AppException const&) {
+		return false;
+	}
+	if (cache->size() < sizeof(MeshCacheHeader))
+		return false;
+
+	MeshCacheHeader header;
+	std::memcpy(&header, cache->data(), sizeof(MeshCacheHeader));
+	if (std::memcmp(header.magic.data(), SCOP_MESH_CACHE_MAGIC, header.magic.size()) != 0 or header.version != SCOP_MESH_CACHE_VERSION or header.flags != this->_flags)
+		return false;
+	// the strides and the face type are used as they are to draw the mapped buffers
+	uint32_t vboStride = (header.flags & CACHE_PACKED) ? VBO_PACKED_STRIDE : VBO_STRIDE;
+	if (header.vboStride != vboStride or (header.eboSize > 0 and ((header.eboStride != EBO_STRIDE and
+		header.eboStride != EBO_SHORT_STRIDE) or header.eboType > VERTEX_TEXT_VNORM)))
+		return false;
+	std::string const source = this->_objFile.string();
+	if (header.pathSize != source.size() or cache->size() < sizeof(MeshCacheHeader) + header.pathSize or
+		source.compare(0, source.size(), cache->data() + sizeof(MeshCacheHeader), header.pathSize) != 0)
+		return false;
+	size_t vboOffset = alignTo8(sizeof(MeshCacheHeader) + header.pathSize);
+	size_t eboOffset = vboOffset + static_cast<size_t>(header.vboSize) * header.vboStride;
+	size_t rangesOffset = alignTo8(eboOffset + static_cast<size_t>(header.eboSize) * header.eboStride);
+	size_t materialsOffset = rangesOffset + header.rangesCount * sizeof(DrawRange);
+	if (cache->size() != materialsOffset + header.materialsSize)
+		return false;
+	if (header.sourceSize != sourceSize)
+		return false;
+	bool touched = header.sourceMtime != sourceMtime;
+	if (touched) {
+		// same size but touched: the content decides
+		try {
+			if (header.sourceHash != this->_hashSource())
+				return false;
+		} catch (AppException const&) {
+			return false;
+		}
+	}
+
+	std::vector<Material> cachedMaterials;
+	if (this->_deserializeMaterials(std::string_view(cache->data() + materialsOffset, header.materialsSize), cachedMaterials) == false)
+		return false;
+	std::vector<DrawRange> ranges(header.rangesCount);
+	std::memcpy(ranges.data(), cache->data() + rangesOffset, header.rangesCount * sizeof(DrawRange));
+	for (DrawRange const& range : ranges) {
+		if (range.material >= cachedMaterials.size() or static_cast<uint64_t>(range.first) + range.count > header.eboSize)
+			return false;
+	}
+
+	materials = std::move(cachedMaterials);
+	vboData = std::make_shared<VBO>();
+	vboData->size = header.vboSize;
+	vboData->stride = header.vboStride;
+	vboData->format = (header.flags & CACHE_PACKED) ? VERTEX_PACKED : VERTEX_FLOAT;
+	vboData->mapping = cache;
+	vboData->offset = vboOffset;
+	vboData->bounds = header.bounds;
+	eboData.reset();
+	if (header.eboSize > 0) {
+		eboData = std::make_shared<EBO>();
+		eboData->size = header.eboSize;
+		eboData->stride = header.eboStride;
+		eboData->type = static_cast<FaceType>(header.eboType);
+		eboData->ranges = std::move(ranges);
+		eboData->mapping = cache;
+		eboData->offset = eboOffset;
+	}
+	// the content is the same: the next launches don't hash the object file again
+	if (touched)
+		this->_updateSourceMtime(sourceMtime);
+	return true;
+}
+
+bool MeshCache::save( VBO const& vboData, EBO const* eboData, std::vector<Material> const& materials, std::vector<fs::path> const& libraries ) const {
+	SCOP_ZONE("MeshCache::save");
+	MeshCacheHeader header{};
+	std::memcpy(header.magic.data(), SCOP_MESH_CACHE_MAGIC, header.magic.size());
+	header.version = SCOP_MESH_CACHE_VERSION;
+	header.flags = this->_flags;
+	std::string const source = this->_objFile.string();
+	header.pathSize = static_cast<uint32_t>(source.size());
+	try {
+		if (this->_statSource(header.sourceSize, header.sourceMtime) == false)
+			return false;
+		header.sourceHash = this->_hashSource();
+	} catch (AppException const&) {
+		return false;
+	}
+	header.vboSize = vboData.size;
+	header.vboStride = vboData.stride;
+	header.bounds = vboData.bounds;
+	if (eboData) {
+		header.eboSize = eboData->size;
+		header.eboStride = eboData->stride;
+		header.eboType = eboData->type;
+		header.rangesCount = static_cast<uint32_t>(eboData->ranges.size());
+	}
+	std::string materialsBlock = this->_serializeMaterials(materials, libraries);
+	header.materialsSize = static_cast<uint32_t>(materialsBlock.size());
+
+	// written aside and renamed: a crash never leaves a half written cache
+	fs::path tmpFile = this->_cacheFile;
+	tmpFile += ".tmp";
+	{
+		std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+		std::array<char,8> padding{};
+		out.write(reinterpret_cast<char const*>(&header), sizeof(MeshCacheHeader));
+		out.write(source.data(), source.size());
+		out.write(padding.data(), alignTo8(sizeof(MeshCacheHeader) + source.size()) - sizeof(MeshCacheHeader) - source.size());
+		out.write(reinterpret_cast<char const*>(vboData.getData()), static_cast<size_t>(vboData.size) * vboData.stride);
+		size_t written = alignTo8(sizeof(MeshCacheHeader) + source.size()) + static_cast<size_t>(vboData.size) * vboData.stride;
+		if (eboData) {
+			out.write(reinterpret_cast<char const*>(eboData->getData()), static_cast<size_t>(eboData->size) * eboData->stride);
+			written += static_cast<size_t>(eboData->size) * eboData->stride;
+		}
+		out.write(padding.data(), alignTo8(written) - written);
+		if (eboData)
+			out.write(reinterpret_cast<char const*>(eboData->ranges.data()), eboData->ranges.size() * sizeof(DrawRange));
+		out.write(materialsBlock.data(), materialsBlock.size());
+		if (!out) {
+			std::cerr << "couldn't write mesh cache: " << this->_cacheFile.string() << std::endl;
+			std::error_code error;
+			fs::remove(tmpFile, error);
+			return false;
+		}
+	}
+	std::error_code error;
+	fs::rename(tmpFile, this->_cacheFile, error);
+	if (error) {
+		std::cerr << "couldn't write mesh cache: " << this->_cacheFile.string() << std::endl;
+		fs::remove(tmpFile, error);
+		return false;
+	}
+	return true;
+}
+
+void MeshCache::_updateSourceMtime( int64_t sourceMtime ) const noexcept {
+	// in place, only the mtime changes; a read-only cache is hashed at every launch
+	std::fstream file(this->_cacheFile, std::ios::binary | std::ios::in | std::ios::out);
+	if (!file)
+		return;
+	file.seekp(offsetof(MeshCacheHeader, sourceMtime));
+	file.write(reinterpret_cast<char const*>(&sourceMtime), sizeof(sourceMtime));
+}
+
+fs::path MeshCache::getCacheFile( void ) const noexcept {
+	return this->_cacheFile;
+}
+
+bool MeshCache::_statSource( uint64_t& size, int64_t& mtime ) const noexcept {
+	return statFile(this->_objFile, size, mtime);
+}
+
+uint64_t MeshCache::_hashSource( void ) const {
+	// FNV-1a, 64 bits
+	MappedFile source(this->_objFile.string());
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (char c : source.view()) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+std::string MeshCache::_serializeMaterials( std::vector<Material> const& materials, std::vector<fs::path> const& libraries ) const {
+	std::string block;
+	// a library missing when the cache is written is stored as missing: the cache is outdated once it appears
+	writeValue(block, static_cast<uint32_t>(libraries.size()));
+	for (fs::path const& library : libraries) {
+		uint64_t size = UINT64_MAX;
+		int64_t mtime = 0;
+		statFile(library, size, mtime);
+		writeString(block, fs::absolute(library).lexically_normal().string());
+		writeValue(block, size);
+		writeValue(block, mtime);
+	}
+	writeValue(block, static_cast<uint32_t>(materials.size()));
+	for (Material const& material : materials) {
+		writeString(block, material.name);
+		writeValue(block, material.ambient);
+		writeValue(block, material.diffuse);
+		writeValue(block, material.specular);
+		writeValue(block, material.shininess);
+		writeString(block, material.diffuseMap.empty() ? std::string() : fs::absolute(material.diffuseMap).lexically_normal().string());
+	}
+	return block;
+}
+
+bool MeshCache::_deserializeMaterials( std::string_view block, std::vector<Material>& materials ) const {
+	uint32_t nLibraries;
+	if (readValue(block, nLibraries) == false)
+		return false;
+	for (uint32_t i=0; i<nLibraries; i++) {
+		std::string library;
+		uint64_t cachedSize, size = UINT64_MAX;
+		int64_t cachedMtime, mtime = 0;
+		if (readString(block, library) == false or readValue(block, cachedSize) == false or readValue(block, cachedMtime) == false)
+			return false;
+		statFile(library, size, mtime);
+		if (size != cachedSize or mtime != cachedMtime)
+			return false;
+	}
+
+	uint32_t nMaterials;
+	if (readValue(block, nMaterials) == false or nMaterials == 0)
+		return false;
+	materials.resize(nMaterials);
+	for (Material& material : materials) {
+		std::string diffuseMap;
+		if (readString(block, material.name) == false or readValue(block, material.ambient) == false or
+			readValue(block, material.diffuse) == false or readValue(block, material.specular) == false or
+			readValue(block, material.shininess) == false or readString(block, diffuseMap) == false)
+			return false;
+		material.diffuseMap = diffuseMap;
+	}
+	return block.empty();
+}
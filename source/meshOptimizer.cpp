@@ -0,0 +1,159 @@
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "meshOptimizer.hpp"
+
+
+float computeACMR( uint32_t const* indexes, size_t nIndexes, uint32_t cacheSize ) {
+	if (nIndexes < 3)
+		return 0.0f;
+	uint32_t nVertexes = *std::max_element(indexes, indexes + nIndexes) + 1;
+	// a vertex is in the FIFO if less than cacheSize misses happened after it was loaded
+	std::vector<size_t> loadedAt(nVertexes, SIZE_MAX);
+	size_t misses = 0;
+	for (size_t i=0; i<nIndexes; i++) {
+		size_t& loaded = loadedAt[indexes[i]];
+		if (loaded == SIZE_MAX or misses - loaded >= cacheSize)
+			loaded = misses++;
+	}
+	return static_cast<float>(misses) / static_cast<float>(nIndexes / 3);
+}
+
+// scores of the paper: a vertex used by the last triangle is worth a bit less than the next ones in the cache
+// (it would make strips), the score decays with the position in the cache; vertexes with few triangles
+// left get a boost, so they are finished and leave the cache
+static constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+static constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float FORSYTH_CACHE_DECAY = 1.5f;
+static constexpr float FORSYTH_VALENCE_SCALE = 2.0f;
+static constexpr float FORSYTH_VALENCE_POWER = 0.5f;
+
+static float vertexScore( int32_t cachePosition, uint32_t activeTriangles ) noexcept {
+	if (activeTriangles == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 3) {
+		float scaled = 1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+		score = powf(scaled, FORSYTH_CACHE_DECAY);
+	}
+	else if (cachePosition >= 0)
+		score = FORSYTH_LAST_TRIANGLE_SCORE;
+	return score + FORSYTH_VALENCE_SCALE * powf(static_cast<float>(activeTriangles), -FORSYTH_VALENCE_POWER);
+}
+
+void optimizeVertexCache( uint32_t* indexes, size_t nIndexes, uint32_t nVertexes ) {
+	size_t nTriangles = nIndexes / 3;
+	if (nTriangles < 2)
+		return;
+
+	// triangles of every vertex (offsets + flat list), only the first activeTriangles[v] are still to add
+	std::vector<uint32_t> activeTriangles(nVertexes, 0U);
+	for (size_t i=0; i<nTriangles * 3; i++)
+		activeTriangles[indexes[i]]++;
+	std::vector<size_t> firstTriangle(nVertexes + 1, 0U);
+	for (uint32_t v=0; v<nVertexes; v++)
+		firstTriangle[v + 1] = firstTriangle[v] + activeTriangles[v];
+	std::vector<uint32_t> vertexTriangles(firstTriangle.back());
+	std::vector<uint32_t> filled(nVertexes, 0U);
+	for (size_t t=0; t<nTriangles; t++) {
+		for (uint32_t j=0; j<3; j++) {
+			uint32_t v = indexes[t * 3 + j];
+			vertexTriangles[firstTriangle[v] + filled[v]++] = static_cast<uint32_t>(t);
+		}
+	}
+
+	std::vector<int32_t> cachePosition(nVertexes, -1);
+	std::vector<float> scores(nVertexes);
+	for (uint32_t v=0; v<nVertexes; v++)
+		scores[v] = vertexScore(-1, activeTriangles[v]);
+	std::vector<float> triangleScores(nTriangles);
+	std::vector<uint8_t> added(nTriangles, 0);
+	size_t best = 0;
+	for (size_t t=0; t<nTriangles; t++) {
+		triangleScores[t] = scores[indexes[t * 3]] + scores[indexes[t * 3 + 1]] + scores[indexes[t * 3 + 2]];
+		if (triangleScores[t] > triangleScores[best])
+			best = t;
+	}
+
+	std::vector<uint32_t> ordered(nTriangles * 3);
+	std::vector<uint32_t> cache, newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+	size_t nextInOrder = 0;
+	for (size_t emitted=0; emitted<nTriangles; emitted++) {
+		// no triangle left around the cache: restart from the first one not added
+		if (best == SIZE_MAX) {
+			while (added[nextInOrder])
+				nextInOrder++;
+			best = nextInOrder;
+		}
+		std::array<uint32_t,3> triangle{indexes[best * 3], indexes[best * 3 + 1], indexes[best * 3 + 2]};
+		std::copy(triangle.cbegin(), triangle.cend(), ordered.begin() + emitted * 3);
+		added[best] = 1;
+
+		for (uint32_t v : triangle) {
+			// swap the triangle out of the active ones
+			uint32_t* first = &vertexTriangles[firstTriangle[v]];
+			uint32_t* last = first + activeTriangles[v];
+			std::iter_swap(std::find(first, last, static_cast<uint32_t>(best)), last - 1);
+			activeTriangles[v]--;
+		}
+
+		// the vertexes of the triangle move on top of the cache
+		newCache.clear();
+		for (uint32_t j=0; j<3; j++) {
+			if (std::find(newCache.cbegin(), newCache.cend(), triangle[j]) == newCache.cend())
+				newCache.push_back(triangle[j]);
+		}
+		for (uint32_t v : cache) {
+			if (v != triangle[0] and v != triangle[1] and v != triangle[2])
+				newCache.push_back(v);
+		}
+		for (size_t i=0; i<newCache.size(); i++) {
+			uint32_t v = newCache[i];
+			cachePosition[v] = (i < FORSYTH_CACHE_SIZE) ? static_cast<int32_t>(i) : -1;
+			scores[v] = vertexScore(cachePosition[v], activeTriangles[v]);
+		}
+
+		// only the triangles of the vertexes that moved change score, the best one is searched among them
+		best = SIZE_MAX;
+		float bestScore = -1.0f;
+		for (uint32_t v : newCache) {
+			for (size_t i=firstTriangle[v]; i<firstTriangle[v] + activeTriangles[v]; i++) {
+				uint32_t t = vertexTriangles[i];
+				triangleScores[t] = scores[indexes[t * 3]] + scores[indexes[t * 3 + 1]] + scores[indexes[t * 3 + 2]];
+				if (triangleScores[t] > bestScore) {
+					bestScore = triangleScores[t];
+					best = t;
+				}
+			}
+		}
+		newCache.resize(std::min<size_t>(newCache.size(), FORSYTH_CACHE_SIZE));
+		std::swap(cache, newCache);
+	}
+	std::copy(ordered.cbegin(), ordered.cend(), indexes);
+}
+
+void reorderVertexesByFirstUse( float* vertexes, uint32_t nVertexes, uint32_t vertexSize, uint32_t* indexes, size_t nIndexes ) {
+	std::vector<uint32_t> remap(nVertexes, UINT32_MAX);
+	uint32_t next = 0;
+	for (size_t i=0; i<nIndexes; i++) {
+		if (remap[indexes[i]] == UINT32_MAX)
+			remap[indexes[i]] = next++;
+		indexes[i] = remap[indexes[i]];
+	}
+	// vertexes never used stay after the others
+	for (uint32_t v=0; v<nVertexes; v++) {
+		if (remap[v] == UINT32_MAX)
+			remap[v] = next++;
+	}
+
+	std::vector<float> reordered(static_cast<size_t>(nVertexes) * vertexSize);
+	for (uint32_t v=0; v<nVertexes; v++)
+		std::memcpy(&reordered[static_cast<size_t>(remap[v]) * vertexSize], vertexes + static_cast<size_t>(v) * vertexSize, vertexSize * sizeof(float));
+	std::copy(reordered.cbegin(), reordered.cend(), vertexes);
+}
@@ -0,0 +1,424 @@
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <charconv>
+#include <cctype>
+
+#include "meshReader.hpp"
+#include "data.hpp"
+#include "exception.hpp"
+#include "profiler.hpp"
+
+
+static constexpr size_t STL_HEADER_SIZE = 80;
+static constexpr size_t STL_TRIANGLE_SIZE = 50;
+static constexpr bool HOST_BIG_ENDIAN = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+static_assert(sizeof(VectF3) == 3 * sizeof(float), "vertexes are copied from the files as 3 floats");
+
+template <typename T>
+static T loadNumber( char const* bytes, bool swapBytes ) noexcept {
+	std::array<char,sizeof(T)> raw;
+	std::memcpy(raw.data(), bytes, sizeof(T));
+	if (swapBytes)
+		std::reverse(raw.begin(), raw.end());
+	T value;
+	std::memcpy(&value, raw.data(), sizeof(T));
+	return value;
+}
+
+static bool hasExtension( std::string const& fileName, std::string_view extension ) {
+	if (fileName.size() < extension.size())
+		return false;
+	return std::equal(extension.cbegin(), extension.cend(), fileName.cend() - extension.size(), []( char a, char b ) {
+		return a == std::tolower(static_cast<unsigned char>(b));
+	});
+}
+
+static std::string_view nextWord( std::string_view& line ) noexcept {
+	size_t start = line.find_first_not_of(" \t\r");
+	if (start == std::string_view::npos) {
+		line = std::string_view();
+		return line;
+	}
+	size_t end = std::min(line.find_first_of(" \t\r", start), line.size());
+	std::string_view word = line.substr(start, end - start);
+	line.remove_prefix(end);
+	return word;
+}
+
+MeshFormat detectMeshFormat( std::string_view content, std::string const& fileName ) {
+	if (content.substr(0, 4) == "ply\n" or content.substr(0, 5) == "ply\r\n")
+		return MeshFormat::PLY;
+	// binary STL has no magic number, but its size is given by the triangle count
+	if (content.size() >= STL_HEADER_SIZE + sizeof(uint32_t)) {
+		uint32_t count = loadNumber<uint32_t>(content.data() + STL_HEADER_SIZE, HOST_BIG_ENDIAN);
+		if (content.size() == STL_HEADER_SIZE + sizeof(uint32_t) + static_cast<size_t>(count) * STL_TRIANGLE_SIZE)
+			return MeshFormat::STL;
+	}
+	if (hasExtension(fileName, ".stl"))
+		return MeshFormat::STL;
+	else if (hasExtension(fileName, ".ply"))
+		return MeshFormat::PLY;
+	return MeshFormat::OBJ;
+}
+
+char const* meshFormatToString( MeshFormat format ) noexcept {
+	switch (format) {
+		case MeshFormat::OBJ:
+			return "OBJ";
+		case MeshFormat::STL:
+			return "STL";
+		case MeshFormat::PLY:
+			return "PLY";
+	}
+	return "unknown";
+}
+
+
+void StlReader::read( std::string_view content, ParsedData& data ) const {
+	SCOP_ZONE("StlReader::read");
+	// a binary file can start with "solid" too: only the size tells it from an ascii one
+	if (content.size() < STL_HEADER_SIZE + sizeof(uint32_t))
+		throw ParsingException("STL file too short, ascii STL isn't supported");
+	uint32_t count = loadNumber<uint32_t>(content.data() + STL_HEADER_SIZE, HOST_BIG_ENDIAN);
+	if (content.size() != STL_HEADER_SIZE + sizeof(uint32_t) + static_cast<size_t>(count) * STL_TRIANGLE_SIZE)
+		throw ParsingException("STL file size doesn't match its " + std::to_string(count) + " triangles, ascii STL isn't supported");
+	else if (count == 0)
+		throw ParsingException("No triangles found in STL file");
+
+	// 3 vertexes after the normal of every triangle, copied as they are on little endian cpus
+	data._vertexes.resize(static_cast<size_t>(count) * 3);
+	char const* triangle = content.data() + STL_HEADER_SIZE + sizeof(uint32_t);
+	VectF3* vertex = data._vertexes.data();
+	for (uint32_t i=0; i<count; i++, triangle+=STL_TRIANGLE_SIZE, vertex+=3) {
+		if constexpr (HOST_BIG_ENDIAN) {
+			for (uint32_t j=0; j<3; j++) {
+				char const* position = triangle + sizeof(VectF3) * (j + 1);
+				vertex[j] = VectF3{loadNumber<float>(position, true), loadNumber<float>(position + 4, true), loadNumber<float>(position + 8, true)};
+			}
+		} else
+			std::memcpy(vertex, triangle + sizeof(VectF3), 3 * sizeof(VectF3));
+	}
+	data._faces.resize(count, 3);
+	for (uint32_t i=0; i<count; i++) {
+		VectUI3* corners = data._faces.getCorners(i);
+		for (uint32_t j=0; j<3; j++)
+			corners[j] = VectUI3{i * 3 + j, 0U, 0U};
+	}
+}
+
+
+void PlyReader::read( std::string_view content, ParsedData& data ) {
+	SCOP_ZONE("PlyReader::read");
+	std::string_view body = this->_readHeader(content);
+	bool hasVertexes = false;
+	for (Element const& element : this->_elements) {
+		size_t used;
+		if (element.name == "vertex") {
+			used = this->_readVertexes(body, element, data);
+			hasVertexes = true;
+		} else if (element.name == "face") {
+			if (hasVertexes == false)
+				throw ParsingException("PLY faces before the vertexes aren't supported");
+			used = this->_readFaces(body, element, data);
+		} else
+			used = this->_skipElement(body, element);
+		body.remove_prefix(used);
+	}
+	if (data._vertexes.empty())
+		throw ParsingException("No vertexes found in PLY file");
+}
+
+std::string_view PlyReader::_readHeader( std::string_view content ) {
+	this->_elements.clear();
+	bool hasFormat = false;
+	// the first line is the magic number
+	content.remove_prefix(content.find('\n') + 1);
+	while (content.empty() == false) {
+		size_t endLine = content.find('\n');
+		if (endLine == std::string_view::npos)
+			break;
+		std::string_view line = content.substr(0, endLine);
+		content.remove_prefix(endLine + 1);
+		std::string_view keyword = nextWord(line);
+
+		if (keyword == "end_header") {
+			if (hasFormat == false)
+				throw ParsingException("PLY header without format");
+			return content;
+		} else if (keyword == "format") {
+			std::string_view format = nextWord(line);
+			if (format == "binary_little_endian")
+				this->_swapBytes = HOST_BIG_ENDIAN;
+			else if (format == "binary_big_endian")
+				this->_swapBytes = !HOST_BIG_ENDIAN;
+			else
+				throw ParsingException("PLY format not supported (only binary): " + std::string(format));
+			hasFormat = true;
+		} else if (keyword == "element") {
+			Element element;
+			element.name = nextWord(line);
+			std::string_view count = nextWord(line);
+			if (std::from_chars(count.data(), count.data() + count.size(), element.count).ec != std::errc())
+				throw ParsingException("Invalid PLY element count: " + std::string(count));
+			this->_elements.push_back(std::move(element));
+		} else if (keyword == "property") {
+			if (this->_elements.empty())
+				throw ParsingException("PLY property outside of an element");
+			Property property{};
+			std::string_view type = nextWord(line);
+			if (type == "list") {
+				property.isList = true;
+				property.countType = _parseType(nextWord(line));
+				if (property.countType == PLY_FLOAT32 or property.countType == PLY_FLOAT64)
+					throw ParsingException("PLY list count must be an integer");
+				type = nextWord(line);
+			}
+			property.type = _parseType(type);
+			property.name = nextWord(line);
+			this->_elements.back().properties.push_back(std::move(property));
+		} else if (keyword != "comment" and keyword != "obj_info" and keyword.empty() == false)
+			throw ParsingException("Invalid PLY header line: " + std::string(keyword) + std::string(line));
+	}
+	throw ParsingException("PLY header without end_header");
+}
+
+size_t PlyReader::_readVertexes( std::string_view body, Element const& element, ParsedData& data ) const {
+	// x, y, z, nx, ny, nz, u, v: offsets in the vertex, -1 if missing
+	static constexpr std::array<std::array<char const*,3>,8> NAMES{{
+		{"x", "x", "x"}, {"y", "y", "y"}, {"z", "z", "z"}, {"nx", "nx", "nx"}, {"ny", "ny", "ny"}, {"nz", "nz", "nz"},
+		{"u", "s", "texture_u"}, {"v", "t", "texture_v"}
+	}};
+	std::array<int64_t,8> offsets;
+	std::array<PlyType,8> types{};
+	offsets.fill(-1);
+	size_t stride = 0;
+	for (Property const& property : element.properties) {
+		if (property.isList)
+			throw ParsingException("PLY list property in vertexes isn't supported: " + property.name);
+		for (size_t field=0; field<NAMES.size(); field++) {
+			if (offsets[field] == -1 and std::find(NAMES[field].cbegin(), NAMES[field].cend(), property.name) != NAMES[field].cend()) {
+				offsets[field] = static_cast<int64_t>(stride);
+				types[field] = property.type;
+			}
+		}
+		stride += _typeSize(property.type);
+	}
+	if (offsets[0] == -1 or offsets[1] == -1 or offsets[2] == -1)
+		throw ParsingException("PLY vertexes without x, y and z");
+	if (element.count > body.size() / stride)
+		throw ParsingException("PLY file truncated in the vertexes");
+	else if (element.count > UINT32_MAX)
+		throw ParsingException("Too many vertexes in PLY file: " + std::to_string(element.count));
+
+	size_t count = static_cast<size_t>(element.count);
+	char const* vertex = body.data();
+	auto loadVector = [&]( size_t first, size_t i ) {
+		char const* values = vertex + i * stride;
+		return VectF3{
+			static_cast<float>(_loadValue(types[first], values + offsets[first], this->_swapBytes)),
+			static_cast<float>(_loadValue(types[first + 1], values + offsets[first + 1], this->_swapBytes)),
+			static_cast<float>(_loadValue(types[first + 2], values + offsets[first + 2], this->_swapBytes))
+		};
+	};
+	data._vertexes.resize(count);
+	// the usual layout, float x y z first: copied as it is
+	bool floatPositions = this->_swapBytes == false and offsets[0] == 0 and offsets[1] == 4 and offsets[2] == 8 and
+		types[0] == PLY_FLOAT32 and types[1] == PLY_FLOAT32 and types[2] == PLY_FLOAT32;
+	if (floatPositions and stride == sizeof(VectF3))
+		std::memcpy(data._vertexes.data(), vertex, count * sizeof(VectF3));
+	else if (floatPositions) {
+		for (size_t i=0; i<count; i++)
+			std::memcpy(&data._vertexes[i], vertex + i * stride, sizeof(VectF3));
+	} else {
+		for (size_t i=0; i<count; i++)
+			data._vertexes[i] = loadVector(0, i);
+	}
+	if (offsets[3] != -1 and offsets[4] != -1 and offsets[5] != -1) {
+		data._normals.resize(count);
+		for (size_t i=0; i<count; i++)
+			data._normals[i] = loadVector(3, i);
+	}
+	if (offsets[6] != -1 and offsets[7] != -1) {
+		data._textures.resize(count);
+		for (size_t i=0; i<count; i++) {
+			char const* values = vertex + i * stride;
+			data._textures[i] = VectF2{static_cast<float>(_loadValue(types[6], values + offsets[6], this->_swapBytes)),
+				static_cast<float>(_loadValue(types[7], values + offsets[7], this->_swapBytes))};
+		}
+	}
+	return count * stride;
+}
+
+size_t PlyReader::_readFaces( std::string_view body, Element const& element, ParsedData& data ) const {
+	// normals and uvs belong to the vertexes: a corner uses the same index for the 3 of them
+	FaceType type = VERTEX;
+	if (data._textures.empty() == false and data._normals.empty() == false)
+		type = VERTEX_TEXT_VNORM;
+	else if (data._textures.empty() == false)
+		type = VERTEX_TEXT;
+	else if (data._normals.empty() == false)
+		type = VERTEX_VNORM;
+	uint64_t nVertexes = data._vertexes.size();
+	// the smallest face: its count and 3 indexes, the other lists empty
+	bool hasIndexes = false;
+	size_t minFaceSize = 0;
+	for (Property const& property : element.properties) {
+		bool isIndexes = property.isList and (property.name == "vertex_indices" or property.name == "vertex_index");
+		hasIndexes = hasIndexes or isIndexes;
+		if (property.isList == false)
+			minFaceSize += _typeSize(property.type);
+		else
+			minFaceSize += _typeSize(property.countType) + (isIndexes ? 3 * _typeSize(property.type) : 0);
+	}
+	if (hasIndexes == false)
+		throw ParsingException("PLY faces without vertex_indices");
+	else if (element.count > body.size() / minFaceSize)
+		throw ParsingException("PLY file truncated in the faces");
+	else if (element.count > UINT32_MAX)
+		throw ParsingException("Too many faces in PLY file: " + std::to_string(element.count));
+
+	data._faces.reserve(element.count, element.count * 3);
+	std::vector<VectUI3> corners;
+	FaceAttributes attributes;
+	size_t offset = 0;
+	for (uint64_t face=0; face<element.count; face++) {
+		for (Property const& property : element.properties) {
+			size_t itemSize = _typeSize(property.type);
+			if (property.isList == false) {
+				offset += itemSize;
+				continue;
+			}
+			size_t countSize = _typeSize(property.countType);
+			if (offset + countSize > body.size())
+				throw ParsingException("PLY file truncated in the faces");
+			// the count types are integers: exact in the double, a signed one can be negative
+			int64_t nItems = static_cast<int64_t>(_loadValue(property.countType, body.data() + offset, this->_swapBytes));
+			offset += countSize;
+			if (nItems < 0)
+				throw ParsingException("Negative PLY list count in the faces: " + std::to_string(nItems));
+			else if (static_cast<uint64_t>(nItems) > (body.size() - offset) / itemSize)
+				throw ParsingException("PLY file truncated in the faces");
+			if (property.name != "vertex_indices" and property.name != "vertex_index") {
+				offset += static_cast<size_t>(nItems) * itemSize;
+				continue;
+			}
+			if (nItems < 3)
+				throw ParsingException("Not enought face coordinates provided, minimum 3: " + std::to_string(nItems));
+			corners.resize(static_cast<size_t>(nItems));
+			for (int64_t i=0; i<nItems; i++, offset+=itemSize) {
+				int64_t index;
+				if (property.type == PLY_INT32 or property.type == PLY_UINT32)
+					index = property.type == PLY_INT32 ? loadNumber<int32_t>(body.data() + offset, this->_swapBytes) :
+						static_cast<int64_t>(loadNumber<uint32_t>(body.data() + offset, this->_swapBytes));
+				else
+					index = static_cast<int64_t>(_loadValue(property.type, body.data() + offset, this->_swapBytes));
+				if (index < 0 or static_cast<uint64_t>(index) >= nVertexes)
+					throw ParsingException("PLY face index out of range: " + std::to_string(index));
+				uint32_t vertex = static_cast<uint32_t>(index);
+				corners[i] = VectUI3{vertex, vertex, vertex};
+			}
+			data._faces.push(type, corners.data(), static_cast<uint32_t>(nItems), attributes);
+		}
+		if (offset > body.size())
+			throw ParsingException("PLY file truncated in the faces");
+	}
+	return offset;
+}
+
+size_t PlyReader::_skipElement( std::string_view body, Element const& element ) const {
+	size_t stride = 0;
+	bool hasLists = false;
+	for (Property const& property : element.properties) {
+		hasLists = hasLists or property.isList;
+		stride += _typeSize(property.type);
+	}
+	if (hasLists == false) {
+		if (stride > 0 and element.count > body.size() / stride)
+			throw ParsingException("PLY file truncated in element: " + element.name);
+		return static_cast<size_t>(element.count) * stride;
+	}
+	// lists: every item has to be walked to find the end
+	size_t offset = 0;
+	for (uint64_t item=0; item<element.count; item++) {
+		for (Property const& property : element.properties) {
+			if (property.isList == false) {
+				offset += _typeSize(property.type);
+				continue;
+			}
+			if (offset + _typeSize(property.countType) > body.size())
+				throw ParsingException("PLY file truncated in element: " + element.name);
+			int64_t nItems = static_cast<int64_t>(_loadValue(property.countType, body.data() + offset, this->_swapBytes));
+			offset += _typeSize(property.countType);
+			if (nItems < 0)
+				throw ParsingException("Negative PLY list count in element: " + element.name);
+			else if (static_cast<uint64_t>(nItems) > (body.size() - offset) / _typeSize(property.type))
+				throw ParsingException("PLY file truncated in element: " + element.name);
+			offset += static_cast<size_t>(nItems) * _typeSize(property.type);
+		}
+		if (offset > body.size())
+			throw ParsingException("PLY file truncated in element: " + element.name);
+	}
+	return offset;
+}
+
+PlyReader::PlyType PlyReader::_parseType( std::string_view type ) {
+	if (type == "char" or type == "int8")
+		return PLY_INT8;
+	else if (type == "uchar" or type == "uint8")
+		return PLY_UINT8;
+	else if (type == "short" or type == "int16")
+		return PLY_INT16;
+	else if (type == "ushort" or type == "uint16")
+		return PLY_UINT16;
+	else if (type == "int" or type == "int32")
+		return PLY_INT32;
+	else if (type == "uint" or type == "uint32")
+		return PLY_UINT32;
+	else if (type == "float" or type == "float32")
+		return PLY_FLOAT32;
+	else if (type == "double" or type == "float64")
+		return PLY_FLOAT64;
+	throw ParsingException("Invalid PLY property type: " + std::string(type));
+}
+
+size_t PlyReader::_typeSize( PlyType type ) noexcept {
+	switch (type) {
+		case PLY_INT8:
+		case PLY_UINT8:
+			return 1;
+		case PLY_INT16:
+		case PLY_UINT16:
+			return 2;
+		case PLY_INT32:
+		case PLY_UINT32:
+		case PLY_FLOAT32:
+			return 4;
+		case PLY_FLOAT64:
+			return 8;
+	}
+	return 0;
+}
+
+double PlyReader::_loadValue( PlyType type, char const* bytes, bool swapBytes ) noexcept {
+	switch (type) {
+		case PLY_INT8:
+			return loadNumber<int8_t>(bytes, swapBytes);
+		case PLY_UINT8:
+			return loadNumber<uint8_t>(bytes, swapBytes);
+		case PLY_INT16:
+			return loadNumber<int16_t>(bytes, swapBytes);
+		case PLY_UINT16:
+			return loadNumber<uint16_t>(bytes, swapBytes);
+		case PLY_INT32:
+			return loadNumber<int32_t>(bytes, swapBytes);
+		case PLY_UINT32:
+			return loadNumber<uint32_t>(bytes, swapBytes);
+		case PLY_FLOAT32:
+			return loadNumber<float>(bytes, swapBytes);
+		case PLY_FLOAT64:
+			return loadNumber<double>(bytes, swapBytes);
+	}
+	return 0.0;
+}
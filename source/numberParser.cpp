@@ -0,0 +1,169 @@
+#include <cstring>
+#include <climits>
+
+#include "numberParser.hpp"
+#include "exception.hpp"
+
+
+// powers of ten exact in double
+static constexpr std::array<double,23> POWERS_OF_TEN{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isBlank( char c ) noexcept {
+	return c == ' ' or c == '\t' or c == '\r';
+}
+
+static inline bool isDigit( char c ) noexcept {
+	return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// the leading '+' that stof used to skip, from_chars doesn't accept it
+static inline char const* skipPlus( char const* first, char const* last ) noexcept {
+	if (last - first > 1 and first[0] == '+' and first[1] != '-')
+		return first + 1;
+	return first;
+}
+
+std::from_chars_result parseFloat( char const* first, char const* last, float& value ) noexcept {
+	char const* start = skipPlus(first, last);
+	char const* it = start;
+	bool negative = it != last and *it == '-';
+	if (negative)
+		it++;
+
+	// digits before and after the dot in a single integer, the dot moves the exponent
+	uint64_t mantissa = 0U;
+	char const* firstDigit = it;
+	for (; it != last and isDigit(*it); it++)
+		mantissa = mantissa * 10 + static_cast<uint64_t>(*it - '0');
+	int64_t nDigits = it - firstDigit;
+	int32_t exponent = 0;
+	if (it != last and *it == '.') {
+		char const* firstDecimal = ++it;
+		for (; it != last and isDigit(*it); it++)
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*it - '0');
+		exponent = -static_cast<int32_t>(it - firstDecimal);
+		nDigits += it - firstDecimal;
+	}
+	// inf, nan and malformed numbers: from_chars decides
+	if (nDigits == 0)
+		return std::from_chars(start, last, value);
+	if (it != last and (*it == 'e' or *it == 'E')) {
+		char const* expIt = it + 1;
+		bool negativeExp = expIt != last and *expIt == '-';
+		if (expIt != last and (*expIt == '-' or *expIt == '+'))
+			expIt++;
+		// "1e" is read as 1 by from_chars
+		if (expIt == last or isDigit(*expIt) == false)
+			return std::from_chars(start, last, value);
+		int32_t writtenExp = 0;
+		for (; expIt != last and isDigit(*expIt); expIt++) {
+			if (writtenExp < 100000)
+				writtenExp = writtenExp * 10 + (*expIt - '0');
+		}
+		exponent += negativeExp ? -writtenExp : writtenExp;
+		it = expIt;
+	}
+	// more than 19 digits may have overflowed the mantissa (leading zeros too, rare enough)
+	if (nDigits > 19 or mantissa > (1ULL << 53) or exponent < -22 or exponent > 22)
+		return std::from_chars(start, last, value);
+
+	// a single correctly rounded operation on exact operands
+	double result = static_cast<double>(mantissa);
+	result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+	// a double exactly halfway between two floats may come from a value that isn't: rounding twice could be wrong
+	uint64_t bits;
+	std::memcpy(&bits, &result, sizeof(double));
+	if ((bits & ((1ULL << 29) - 1)) == (1ULL << 28))
+		return std::from_chars(start, last, value);
+	value = static_cast<float>(negative ? -result : result);
+	return std::from_chars_result{it, std::errc()};
+}
+
+std::from_chars_result parseIndex( char const* first, char const* last, int64_t& value ) noexcept {
+	std::from_chars_result result{first, std::errc()};
+	// plain positive index up to 10 digits: no overflow possible in int64_t, the rest goes through from_chars
+	char const* it = first;
+	uint64_t number = 0U;
+	for (; it != last and it - first < 10 and isDigit(*it); it++)
+		number = number * 10 + static_cast<uint64_t>(*it - '0');
+	if (it != first and (it == last or isDigit(*it) == false)) {
+		value = static_cast<int64_t>(number);
+		result.ptr = it;
+	}
+	else
+		result = std::from_chars(skipPlus(first, last), last, value);
+	if (result.ec == std::errc() and (value < INT32_MIN or value > static_cast<int64_t>(UINT32_MAX)))
+		result.ec = std::errc::result_out_of_range;
+	return result;
+}
+
+std::errc parseFaceCorner( std::string_view token, FaceCorner& corner ) noexcept {
+	char const* it = token.data();
+	char const* last = token.data() + token.size();
+	corner.values = {0, 0, 0};
+
+	std::from_chars_result result = parseIndex(it, last, corner.values[0]);
+	if (result.ec != std::errc())
+		return result.ec;
+	if ((it = result.ptr) == last) {
+		corner.type = VERTEX;
+		return std::errc();
+	}
+	else if (*it++ != '/')
+		return std::errc::invalid_argument;
+
+	// "v//n" has no texture
+	bool hasTexture = it == last or *it != '/';
+	if (hasTexture) {
+		result = parseIndex(it, last, corner.values[1]);
+		if (result.ec != std::errc())
+			return result.ec;
+		if ((it = result.ptr) == last) {
+			corner.type = VERTEX_TEXT;
+			return std::errc();
+		}
+		else if (*it != '/')
+			return std::errc::invalid_argument;
+	}
+	result = parseIndex(it + 1, last, corner.values[2]);
+	if (result.ec != std::errc())
+		return result.ec;
+	else if (result.ptr != last)
+		return std::errc::invalid_argument;
+	corner.type = hasTexture ? VERTEX_TEXT_VNORM : VERTEX_VNORM;
+	return std::errc();
+}
+
+std::string_view trimBlanks( std::string_view content ) noexcept {
+	size_t leftTrim = 0, rightTrim = content.size();
+	while (leftTrim < rightTrim and isBlank(content[leftTrim]))
+		leftTrim++;
+	while (rightTrim > leftTrim and isBlank(content[rightTrim - 1]))
+		rightTrim--;
+	return content.substr(leftTrim, rightTrim - leftTrim);
+}
+
+std::string_view nextToken( std::string_view& content ) noexcept {
+	size_t start = 0;
+	while (start < content.size() and isBlank(content[start]))
+		start++;
+	size_t end = start;
+	while (end < content.size() and !isBlank(content[end]))
+		end++;
+	std::string_view token = content.substr(start, end - start);
+	content.remove_prefix(end);
+	return token;
+}
+
+float tokenToFloat( std::string_view strNumber ) {
+	float number = 0.0f;
+	std::from_chars_result result = parseFloat(strNumber.data(), strNumber.data() + strNumber.size(), number);
+	if (result.ec == std::errc::invalid_argument)
+		throw ParsingException("Invalid number parsed: " + std::string(strNumber));
+	else if (result.ec == std::errc::result_out_of_range)
+		throw ParsingException("Invalid number parsed, overflow: " + std::string(strNumber));
+	return number;
+}
@@ -1,74 +1,16 @@
-#include <fstream>
-#include <sstream>
+#include <charconv>
+#include <algorithm>
+#include <exception>
 
 #include "parser.hpp"
 #include "data.hpp"
 #include "exception.hpp"
-
-
-std::string	faceToString( FaceType face ) {
-	switch (face) {
-		case VERTEX:
-			return "VERTEX";
-		case VERTEX_TEXT:
-			return "VERTEX_TEXT";
-		case VERTEX_VNORM:
-			return "VERTEX_VNORM";
-		case VERTEX_TEXT_VNORM:
-			return "VERTEX_TEXT_VNORM";
-		default:
-			return "[invalid value: " + std::to_string(face) + "]";
-	}
-}
-
-
-void Face::setFaceType( FaceType newType ) noexcept {
-	this->_type = newType;
-}
-
-void Face::setIndexes( std::vector<VectUI3> const& indexes ) noexcept {
-	this->_indexes = indexes;
-}
-
-void Face::setObject( std::string const& newObject ) noexcept {
-	this->_object = newObject;
-}
-
-void Face::setGroup( std::string const& newGroup ) noexcept {
-	this->_group = newGroup;
-}
-
-void Face::setMaterial( std::string const& newMaterial) noexcept {
-	this->_material = newMaterial;
-}
-
-void Face::setSmoothing( uint32_t newSmoothing ) noexcept {
-	this->_smoothing = newSmoothing;
-}
-
-FaceType Face::getFaceType( void ) const noexcept {
-	return this->_type;
-}
-
-std::vector<VectUI3> const& Face::getIndexes( void ) const noexcept {
-	return this->_indexes;
-}
-
-std::string Face::getObject( void ) const noexcept {
-	return this->_object;
-}
-
-std::string Face::getGroup( void ) const noexcept {
-	return this->_group;
-}
-
-std::string Face::getMaterial( void ) const noexcept {
-	return this->_material;
-}
-
-uint32_t Face::getSmoothing( void ) const noexcept {
-	return this->_smoothing;
-}
+#include "mappedFile.hpp"
+#include "inputStream.hpp"
+#include "meshReader.hpp"
+#include "numberParser.hpp"
+#include "define.hpp"
+#include "profiler.hpp"
 
 
 void Line::setObject( std::string const& newObject ) noexcept {
@@ -108,45 +50,6 @@ uint32_t Line::getSmoothing( void ) const noexcept {
 }
 
 
-std::ostream& operator<<(std::ostream& os, FaceType type) {
-	os << faceToString(type);
-	return os;
-}
-
-std::ostream& operator<<(std::ostream& os, Face const& obj) {
-	switch (obj.getFaceType()) {
-		case (VERTEX):
-			for (VectUI3 const& faceIndex : obj.getIndexes()) {
-				os << faceIndex.i1 + 1 << " ";
-			}
-			break;
-		case (VERTEX_TEXT):
-			for (VectUI3 const& faceIndex : obj.getIndexes()) {
-				os << faceIndex.i1 + 1 << "/" << faceIndex.i2 + 1 << " ";
-			}
-			break;
-		case (VERTEX_VNORM):
-			for (VectUI3 const& faceIndex : obj.getIndexes()) {
-				os << faceIndex.i1 + 1 << "//" << faceIndex.i3 + 1 << " ";
-			}
-			break;
-		case (VERTEX_TEXT_VNORM):
-			for (VectUI3 const& faceIndex : obj.getIndexes()) {
-				os << faceIndex.i1 + 1 << "/" << faceIndex.i2 + 1 << "/" << faceIndex.i3 + 1 << " ";
-			}
-			break;
-	}
-	if (obj.getObject().length() > 0)
-		os << "|object: " << obj.getObject() << "|";
-	if (obj.getGroup().length() > 0)
-		os << "|group: " << obj.getGroup() << "|";
-	if (obj.getMaterial().length() > 0)
-		os << "|material: " << obj.getMaterial() << "|";
-	if (obj.getSmoothing() != 0)
-		os << "|smoothing: " << obj.getSmoothing() << "|";
-	return os;
-}
-
 std::ostream& operator<<(std::ostream& os, Line const& obj) {
 	for (uint32_t lineIndex : obj.getIndexes()) {
 		os << lineIndex << " ";
@@ -163,78 +66,363 @@ std::ostream& operator<<(std::ostream& os, Line const& obj) {
 }
 
 
-ParsedData FileParser::parse( std::string const& fileName ) {
-	ParsedData data;
-	this->_currentObject = "";
-	this->_currentGroup = "";
-	this->_currentSmoothing = 0;
-	this->_currentMaterial = "";
+ParsedData FileParser::parse( std::string const& fileName, uint32_t threads ) {
+	ThreadPool pool(threads);
+	return this->parse(fileName, pool);
+}
 
-	std::ifstream streamFile(fileName);
-	if (!streamFile)
-		throw ParsingException("Error while opening file: " + fileName);
+ParsedData FileParser::parse( std::string const& fileName, ThreadPool& pool ) {
+	SCOP_ZONE("FileParser::parse");
+	this->_currentObject = 0U;
+	this->_currentGroup = 0U;
+	this->_currentSmoothing = 0U;
+	this->_currentMaterial = 0U;
 	this->_objFile = fileName;
+	this->_reportedFaces = 0U;
+
+	ParsedData data;
+	this->_format = MeshFormat::OBJ;
+	// stdin and compressed files can't be mapped, they are decompressed block by block
+	if (fileName == "-" or detectCompression(fileName) != Compression::NONE) {
+		this->_parseStream(fileName, pool, data);
+		return data;
+	}
 
+	std::unique_ptr<MappedFile> mappedFile;
 	try {
-		std::string line;
-		while (std::getline(streamFile, line)) {
-			line = this->_trimString(line);
-			// skip empty lines
-			if (line.length() == 0)
-			continue;
-			// skip comments
-			if (line[0] == '#')
+		mappedFile = std::make_unique<MappedFile>(fileName);
+	}
+	catch (AppException const& error) {
+		throw ParsingException("Error while opening file: " + fileName);
+	}
+	this->_compression = Compression::NONE;
+	this->_readBytes = mappedFile->size();
+	this->_inputBytes = mappedFile->size();
+	// binary formats are read straight into the arrays, then go through the same steps as an object file
+	this->_format = detectMeshFormat(mappedFile->view(), fileName);
+	if (this->_format == MeshFormat::STL)
+		StlReader().read(mappedFile->view(), data);
+	else if (this->_format == MeshFormat::PLY)
+		PlyReader().read(mappedFile->view(), data);
+	else if (!this->_progress)
+		this->_parseBlock(mappedFile->view(), pool, data);
+	else {
+		// blocks ending with a full line, the state left by a block is the starting state of the next one
+		std::string_view buffer = mappedFile->view();
+		while (buffer.empty() == false) {
+			size_t endBlock = buffer.size();
+			if (endBlock > SCOP_PARSE_PROGRESS_BLOCK)
+				endBlock = std::min(buffer.find('\n', SCOP_PARSE_PROGRESS_BLOCK), buffer.size() - 1) + 1;
+			this->_parseBlock(buffer.substr(0, endBlock), pool, data);
+			this->_reportProgress(data);
+			buffer.remove_prefix(endBlock);
+		}
+	}
+	this->_reportProgress(data);
+	return data;
+}
+
+void FileParser::setProgress( ParseProgress progress ) {
+	this->_progress = std::move(progress);
+}
+
+MeshFormat FileParser::getFormat( void ) const noexcept {
+	return this->_format;
+}
+
+Compression FileParser::getCompression( void ) const noexcept {
+	return this->_compression;
+}
+
+uint64_t FileParser::getReadBytes( void ) const noexcept {
+	return this->_readBytes;
+}
+
+uint64_t FileParser::getInputBytes( void ) const noexcept {
+	return this->_inputBytes;
+}
+
+void FileParser::_parseStream( std::string const& fileName, ThreadPool& pool, ParsedData& data ) {
+	StreamPipeline pipeline(fileName);
+	this->_compression = pipeline.getCompression();
+	this->_inputBytes = 0U;
+	// a block ends in the middle of a line: its start waits for the next block
+	std::string carry;
+	std::string_view block;
+	while ((block = pipeline.next()).empty() == false) {
+		this->_inputBytes += block.size();
+		size_t lastNewline = block.rfind('\n');
+		if (lastNewline == std::string_view::npos) {
+			carry.append(block);
 			continue;
-			this->_parseDirective(line, data);
 		}
+		if (carry.empty() == false) {
+			size_t firstNewline = block.find('\n');
+			carry.append(block.substr(0, firstNewline + 1));
+			this->_parseBuffer(carry, data);
+			block.remove_prefix(firstNewline + 1);
+			lastNewline -= firstNewline + 1;
+		}
+		// the reader fills the other buffer meanwhile
+		this->_parseBlock(block.substr(0, lastNewline + 1), pool, data);
+		this->_reportProgress(data);
+		carry.assign(block.substr(lastNewline + 1));
 	}
-	catch (ParsingException const& error) {
-		streamFile.close();
-		throw error;
+	this->_parseBuffer(carry, data);
+	this->_reportProgress(data);
+	this->_readBytes = pipeline.getReadBytes();
+}
+
+void FileParser::_parseBlock( std::string_view buffer, ThreadPool& pool, ParsedData& data ) {
+	// don't use threads for chunks too small to be worth it
+	size_t maxChunks = std::max<size_t>(1, buffer.size() / SCOP_PARSE_MIN_CHUNK);
+	uint32_t nChunks = static_cast<uint32_t>(std::min<size_t>(pool.size(), maxChunks));
+	if (nChunks > 1)
+		this->_parseParallel(buffer, pool, nChunks, data);
+	else
+		this->_parseBuffer(buffer, data);
+}
+
+void FileParser::_parseParallel( std::string_view buffer, ThreadPool& pool, uint32_t nChunks, ParsedData& data ) {
+	// split the file in chunks of about the same size, every chunk ends with a full line
+	std::vector<std::string_view> chunks;
+	size_t chunkSize = buffer.size() / nChunks;
+	while (buffer.empty() == false) {
+		size_t endChunk = buffer.size();
+		if (chunks.size() + 1 < nChunks)
+			endChunk = std::min(buffer.find('\n', chunkSize), buffer.size() - 1) + 1;
+		chunks.push_back(buffer.substr(0, endChunk));
+		buffer.remove_prefix(endChunk);
+	}
+
+	std::vector<FileParser> workers(chunks.size());
+	std::vector<std::unique_ptr<ParsedData>> results(chunks.size());
+	for (size_t i=0; i<chunks.size(); i++) {
+		workers[i]._objFile = this->_objFile;
+		workers[i]._isChunk = true;
+		results[i] = std::unique_ptr<ParsedData>(new ParsedData());
+	}
+	// the error of a chunk is kept for the merge: a relative index out of range in an earlier chunk
+	// is found only there, and comes first in the file
+	std::vector<std::exception_ptr> errors(chunks.size());
+	pool.run(chunks.size(), [&]( size_t i ) {
+		SCOP_ZONE("parse chunk");
+		try {
+			workers[i]._parseBuffer(chunks[i], *results[i]);
+		} catch (...) {
+			errors[i] = std::current_exception();
+		}
+	});
+	SCOP_ZONE("merge chunks");
+
+	// vertexes, textures and normals that come before the chunk
+	std::array<size_t,3> offsets{data._vertexes.size(), data._textures.size(), data._normals.size()};
+	for (size_t i=0; i<chunks.size(); i++) {
+		// the first error in file order, the one a serial parse would have thrown:
+		// the relative indexes of a chunk were all parsed before the line of its error
+		this->_checkRelativeIndexes(workers[i], offsets);
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+		this->_mergeChunk(data, *results[i], workers[i], offsets);
+		offsets = {data._vertexes.size(), data._textures.size(), data._normals.size()};
 	}
-	streamFile.close();
-	return data;
 }
 
-void FileParser::_parseDirective( std::string const& line, ParsedData& data ) {
-	size_t spacePos = line.find(' ');
-	if (spacePos == std::string::npos)
-		throw ParsingException("Invalid line: " + line);
+void FileParser::_mergeChunk( ParsedData& data, ParsedData& chunk, FileParser const& worker, std::array<size_t,3> const& offsets ) {
+	StringTable& names = data._faces.getNames();
+	size_t firstFace = data._faces.size();
+	data._faces.append(chunk._faces);
+
+	// the faces parsed before the chunk changes o/g/usemtl/s belong to the state left by the previous chunk,
+	// relative indexes are rebased on the number of elements parsed by the previous chunks
+	size_t lastToFix = *std::max_element(worker._inheritedFaces.cbegin(), worker._inheritedFaces.cend());
+	for (size_t i=0; i<lastToFix; i++) {
+		FaceAttributes attributes = data._faces.getAttributes(firstFace + i);
+		if (i < worker._inheritedFaces[STATE_OBJECT])
+			attributes.object = this->_currentObject;
+		if (i < worker._inheritedFaces[STATE_GROUP])
+			attributes.group = this->_currentGroup;
+		if (i < worker._inheritedFaces[STATE_MATERIAL])
+			attributes.material = this->_currentMaterial;
+		if (i < worker._inheritedFaces[STATE_SMOOTHING])
+			attributes.smoothing = this->_currentSmoothing;
+		data._faces.setAttributes(firstFace + i, attributes);
+	}
+	for (RelativeIndex const& relative : worker._relativeIndexes) {
+		int64_t index = static_cast<int64_t>(offsets[relative.component]) + relative.index;
+		VectUI3& corner = data._faces.getCorners(firstFace + relative.face)[relative.corner];
+		if (relative.component == 0)
+			corner.i1 = static_cast<uint32_t>(index);
+		else if (relative.component == 1)
+			corner.i2 = static_cast<uint32_t>(index);
+		else
+			corner.i3 = static_cast<uint32_t>(index);
+	}
 
-	std::string lineType = this->_trimString(line.substr(0, spacePos));
-	std::string lineContent = this->_trimString(line.substr(spacePos + 1));
+	auto line = chunk._lines.begin();
+	size_t lastLineToFix = *std::max_element(worker._inheritedLines.cbegin(), worker._inheritedLines.cend());
+	for (size_t i=0; i<lastLineToFix; i++, line++) {
+		if (i < worker._inheritedLines[STATE_OBJECT] and this->_currentObject != 0U)
+			line->setObject(names.getName(this->_currentObject));
+		if (i < worker._inheritedLines[STATE_GROUP] and this->_currentGroup != 0U)
+			line->setGroup(names.getName(this->_currentGroup));
+		if (i < worker._inheritedLines[STATE_MATERIAL] and this->_currentMaterial != 0U)
+			line->setMaterial(names.getName(this->_currentMaterial));
+		if (i < worker._inheritedLines[STATE_SMOOTHING] and this->_currentSmoothing != 0U)
+			line->setSmoothing(this->_currentSmoothing);
+	}
 
+	// the state at the end of the chunk is the starting state of the next one
+	StringTable const& chunkNames = chunk._faces.getNames();
+	if (worker._stateSet[STATE_OBJECT])
+		this->_currentObject = names.intern(chunkNames.getName(worker._currentObject));
+	if (worker._stateSet[STATE_GROUP])
+		this->_currentGroup = names.intern(chunkNames.getName(worker._currentGroup));
+	if (worker._stateSet[STATE_MATERIAL])
+		this->_currentMaterial = names.intern(chunkNames.getName(worker._currentMaterial));
+	if (worker._stateSet[STATE_SMOOTHING])
+		this->_currentSmoothing = worker._currentSmoothing;
+
+	data._tmlFiles.insert(data._tmlFiles.end(), chunk._tmlFiles.cbegin(), chunk._tmlFiles.cend());
+	data._vertexes.insert(data._vertexes.end(), chunk._vertexes.cbegin(), chunk._vertexes.cend());
+	data._textures.insert(data._textures.end(), chunk._textures.cbegin(), chunk._textures.cend());
+	data._normals.insert(data._normals.end(), chunk._normals.cbegin(), chunk._normals.cend());
+	data._paramSpaceVertices.insert(data._paramSpaceVertices.end(), chunk._paramSpaceVertices.cbegin(), chunk._paramSpaceVertices.cend());
+	data._lines.splice(data._lines.end(), chunk._lines);
+}
+
+void FileParser::_checkRelativeIndexes( FileParser const& worker, std::array<size_t,3> const& offsets ) const {
+	// in file order: the first one out of range is the one a serial parse would have found
+	for (RelativeIndex const& relative : worker._relativeIndexes) {
+		if (static_cast<int64_t>(offsets[relative.component]) + relative.index < 0)
+			throw ParsingException("Relative face index out of range: " + std::to_string(relative.value));
+	}
+}
+
+void FileParser::_parseBuffer( std::string_view buffer, ParsedData& data ) {
+	// the scanner finds the lines and their directives in batches, every line is a view on the buffer itself: nothing is copied
+	LineScanner scanner(buffer);
+	std::array<ObjLine,LineScanner::BATCH_SIZE> batch;
+	size_t count;
+	while ((count = scanner.next(batch)) > 0) {
+		for (size_t i=0; i<count; i++) {
+			ObjLine const& line = batch[i];
+			// skip empty lines and comments
+			if (line.directive == DIRECTIVE_EMPTY or line.directive == DIRECTIVE_COMMENT)
+				continue;
+			else if (line.directive != DIRECTIVE_OTHER) {
+				this->_parseContent(line.directive, trimBlanks(line.content), line.line, data);
+				continue;
+			}
+			std::string_view trimmed = trimBlanks(line.line);
+			if (trimmed.length() == 0 or trimmed[0] == '#')
+				continue;
+			this->_parseDirective(trimmed, data);
+		}
+	}
+	// fields never set by the chunk are inherited by all its faces and lines
+	for (uint32_t field=STATE_OBJECT; field<=STATE_SMOOTHING; field++) {
+		if (this->_stateSet[field] == false) {
+			this->_inheritedFaces[field] = data._faces.size();
+			this->_inheritedLines[field] = data._lines.size();
+		}
+	}
+}
+
+void FileParser::_parseDirective( std::string_view line, ParsedData& data ) {
+	size_t spacePos = 0;
+	while (spacePos < line.size() and line[spacePos] != ' ' and line[spacePos] != '\t')
+		spacePos++;
+	if (spacePos == line.size())
+		throw ParsingException("Invalid line: " + std::string(line));
+
+	std::string_view lineType = line.substr(0, spacePos);
+	std::string_view lineContent = trimBlanks(line.substr(spacePos + 1));
+	ObjDirective directive;
 	if (lineType == "mtllib")
-		data._tmlFiles.push_back(this->_createFile(lineContent));
+		directive = DIRECTIVE_MTLLIB;
 	else if (lineType == "v")
-		data._vertexes.push_back(this->_createVertex(lineContent));
+		directive = DIRECTIVE_VERTEX;
 	else if (lineType == "vt")
-		data._textures.push_back(this->_createTexture(lineContent));
+		directive = DIRECTIVE_TEXTURE;
 	else if (lineType == "vn")
-		data._normals.push_back(this->_createVertexNorm(lineContent));
+		directive = DIRECTIVE_NORMAL;
 	else if (lineType == "vp")
-		data._paramSpaceVertices.push_back(this->_createSpaceVertex(lineContent));
+		directive = DIRECTIVE_SPACE_VERTEX;
 	else if (lineType == "f")
-		data._faces.push_back(this->_createFace(lineContent));
+		directive = DIRECTIVE_FACE;
 	else if (lineType == "l")
-		data._lines.push_back(this->_createLine(lineContent));
+		directive = DIRECTIVE_LINE;
 	else if (lineType == "o")
-		this->_currentObject = lineContent;
+		directive = DIRECTIVE_OBJECT;
 	else if (lineType == "g")
-		this->_currentGroup = lineContent;
+		directive = DIRECTIVE_GROUP;
 	else if (lineType == "usemtl")
-		this->_currentMaterial = lineContent;
-	else if (lineType == "s") {
-		if (lineContent != "off")
-			this->_currentSmoothing = this->_parseUint(lineContent);
-		else
-			this->_currentSmoothing = 0U;
-	}
+		directive = DIRECTIVE_USEMTL;
+	else if (lineType == "s")
+		directive = DIRECTIVE_SMOOTHING;
 	else
-		throw ParsingException("Invalid directive in line: " + line);
+		throw ParsingException("Invalid directive in line: " + std::string(line));
+	this->_parseContent(directive, lineContent, line, data);
 }
 
-fs::path FileParser::_createFile( std::string const& content ) const {
+void FileParser::_parseContent( ObjDirective directive, std::string_view lineContent, std::string_view line, ParsedData& data ) {
+	switch (directive) {
+		case DIRECTIVE_MTLLIB:
+			data._tmlFiles.push_back(this->_createFile(lineContent));
+			break;
+		case DIRECTIVE_VERTEX:
+			data._vertexes.push_back(this->_createVertex(lineContent));
+			break;
+		case DIRECTIVE_TEXTURE:
+			data._textures.push_back(this->_createTexture(lineContent));
+			break;
+		case DIRECTIVE_NORMAL:
+			data._normals.push_back(this->_createVertexNorm(lineContent));
+			break;
+		case DIRECTIVE_SPACE_VERTEX:
+			data._paramSpaceVertices.push_back(this->_createSpaceVertex(lineContent));
+			break;
+		case DIRECTIVE_FACE:
+			this->_createFace(lineContent, data);
+			break;
+		case DIRECTIVE_LINE:
+			data._lines.push_back(this->_createLine(lineContent, data));
+			break;
+		case DIRECTIVE_OBJECT:
+			this->_setState(STATE_OBJECT, data);
+			this->_currentObject = data._faces.getNames().intern(lineContent);
+			break;
+		case DIRECTIVE_GROUP:
+			this->_setState(STATE_GROUP, data);
+			this->_currentGroup = data._faces.getNames().intern(lineContent);
+			break;
+		case DIRECTIVE_USEMTL:
+			this->_setState(STATE_MATERIAL, data);
+			this->_currentMaterial = data._faces.getNames().intern(lineContent);
+			break;
+		case DIRECTIVE_SMOOTHING:
+			this->_setState(STATE_SMOOTHING, data);
+			if (lineContent != "off")
+				this->_currentSmoothing = this->_parseUint(lineContent);
+			else
+				this->_currentSmoothing = 0U;
+			break;
+		default:
+			throw ParsingException("Invalid directive in line: " + std::string(line));
+	}
+}
+
+void FileParser::_setState( StateField field, ParsedData const& data ) noexcept {
+	// remember how many faces and lines were parsed before the first change of the field
+	if (this->_stateSet[field])
+		return;
+	this->_stateSet[field] = true;
+	this->_inheritedFaces[field] = data._faces.size();
+	this->_inheritedLines[field] = data._lines.size();
+}
+
+fs::path FileParser::_createFile( std::string_view content ) const {
 	fs::path mtlFile = content;
 	if (mtlFile.is_relative()) {
 		fs::path parent = this->_objFile.parent_path();
@@ -245,241 +433,195 @@ fs::path FileParser::_createFile( std::string const& content ) const {
 	return mtlFile;
 }
 
-VectF3 FileParser::_createVertex( std::string const& content ) const {
-	std::stringstream ss(content);
-	std::string coor;
+VectF3 FileParser::_createVertex( std::string_view content ) const {
+	std::string_view remaining = content;
+	std::string_view coor;
 	float x = 0.0f, y = 0.0f, z = 0.0f, w = 1.0f;
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough vertex coordinates provided: " + content);
-	x = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough vertex coordinates provided: " + std::string(content));
+	x = tokenToFloat(coor);
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough vertex coordinates provided: " + content);
-	y = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough vertex coordinates provided: " + std::string(content));
+	y = tokenToFloat(coor);
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough vertex coordinates provided: " + content);
-	z = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough vertex coordinates provided: " + std::string(content));
+	z = tokenToFloat(coor);
 
-	if (ss >> coor) {
-		w = this->_parseFloat(coor);
+	if (!(coor = nextToken(remaining)).empty()) {
+		w = tokenToFloat(coor);
 		if (w == 0.0f)
 			throw ParsingException("Homogeneus coordinate has value 0 (zero division error)");
 	}
 
-	if (ss >> coor)
-		throw ParsingException("Too many vertex coordinates provided: " + content);
+	if (!nextToken(remaining).empty())
+		throw ParsingException("Too many vertex coordinates provided: " + std::string(content));
 
 	return VectF3{x / w, y / w, z / w};
 }
 
-VectF2 FileParser::_createTexture( std::string const& content ) const {
-	std::stringstream ss(content);
-	std::string coor;
+VectF2 FileParser::_createTexture( std::string_view content ) const {
+	std::string_view remaining = content;
+	std::string_view coor;
 	float u = 0.0f, v = 0.0f;
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough texture coordinates provided: " + content);
-	u = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough texture coordinates provided: " + std::string(content));
+	u = tokenToFloat(coor);
 
-	if (ss >> coor)
-		v = this->_parseFloat(coor);
+	if (!(coor = nextToken(remaining)).empty())
+		v = tokenToFloat(coor);
 
-	if (ss >> coor)
-		throw ParsingException("3D textures are not supported: " + content);
+	if (!nextToken(remaining).empty())
+		throw ParsingException("3D textures are not supported: " + std::string(content));
 
 	return VectF2{u, v};
 }
 
-VectF3 FileParser::_createVertexNorm( std::string const& content ) const {
-	std::stringstream ss(content);
-	std::string coor;
+VectF3 FileParser::_createVertexNorm( std::string_view content ) const {
+	std::string_view remaining = content;
+	std::string_view coor;
 	float x = 0.0f, y = 0.0f, z = 0.0f;
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough normal coordinates provided: " + content);
-	x = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough normal coordinates provided: " + std::string(content));
+	x = tokenToFloat(coor);
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough normal coordinates provided: " + content);
-	y = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough normal coordinates provided: " + std::string(content));
+	y = tokenToFloat(coor);
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough normal coordinates provided: " + content);
-	z = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough normal coordinates provided: " + std::string(content));
+	z = tokenToFloat(coor);
 
-	if (ss >> coor)
-		throw ParsingException("Too many normal coordinates provided: " + content);
+	if (!nextToken(remaining).empty())
+		throw ParsingException("Too many normal coordinates provided: " + std::string(content));
 
 	return VectF3{x, y, z};
 }
 
-VectF3 FileParser::_createSpaceVertex( std::string const& content ) const {
-	std::stringstream ss(content);
-	std::string coor;
+VectF3 FileParser::_createSpaceVertex( std::string_view content ) const {
+	std::string_view remaining = content;
+	std::string_view coor;
 	float u = 0.0f, v = 0.0f, w = 0.0f;
 
-	if (!(ss >> coor))
-		throw ParsingException("Not enough paramSpaceVertex coordinates provided: " + content);
-	u = this->_parseFloat(coor);
+	if ((coor = nextToken(remaining)).empty())
+		throw ParsingException("Not enough paramSpaceVertex coordinates provided: " + std::string(content));
+	u = tokenToFloat(coor);
 
-	if (ss >> coor)
-		v = this->_parseFloat(coor);
+	if (!(coor = nextToken(remaining)).empty())
+		v = tokenToFloat(coor);
 
-	if (ss >> coor)
-		w = this->_parseFloat(coor);
+	if (!(coor = nextToken(remaining)).empty())
+		w = tokenToFloat(coor);
 
-	if (ss >> coor)
-		throw ParsingException("Too many paramSpaceVertex coordinates provided: " + content);
+	if (!nextToken(remaining).empty())
+		throw ParsingException("Too many paramSpaceVertex coordinates provided: " + std::string(content));
 
 	return VectF3{u, v, w};
 }
 
-Face FileParser::_createFace( std::string const& content ) const {
-	std::stringstream ss(content);
-	std::vector<VectUI3> indexList;
-	std::string index;
+void FileParser::_createFace( std::string_view content, ParsedData& data ) {
+	std::string_view remaining = content;
+	std::vector<VectUI3>& indexList = this->_corners;
+	std::string_view index;
 	int32_t faceType = -1;
-
-	// split group of indexes (e.g. 1 or 1/2 or 1/4/5 or 1//3)
-	while (ss >> index) {
-		std::vector<uint32_t> coorList;
-		std::stringstream ssCoor(index);
-		std::string strNumber;
+	indexList.clear();
+
+	// group of indexes (e.g. 1 or 1/2 or 1/4/5 or 1//3) split into vertex index [, texture index, normal index]
+	while (!(index = nextToken(remaining)).empty()) {
+		FaceCorner corner;
+		std::errc error = parseFaceCorner(index, corner);
+		if (error == std::errc::result_out_of_range)
+			throw ParsingException("Invalid number parsed, overflow: " + std::string(index));
+		else if (error != std::errc())
+			throw ParsingException("Invalid number parsed: " + std::string(index));
 		// set faceType or check if is the same
 		if (faceType == -1)
-			faceType = this->_getFaceType(index);
-		else if (faceType != this->_getFaceType(index))
-			throw ParsingException("Different kind of faces on the same line: f " + content);
-		// split group into vertex index [, texture index, normal index]
-		while(std::getline(ssCoor, strNumber, '/')) {
-			// getline considers the string "" as a valid split
-			// in case of two consecutive slashes
-			if (strNumber == "")
+			faceType = corner.type;
+		else if (faceType != corner.type)
+			throw ParsingException("Different kind of faces on the same line: f " + std::string(content));
+
+		// the norm index is always the third in the index struct, 1//3 leaves the texture at 0
+		std::array<uint32_t,3> coorList{0U, 0U, 0U};
+		for (uint32_t component=0; component<3; component++) {
+			int64_t value = corner.values[component];
+			if ((component == 1 and (faceType == VERTEX or faceType == VERTEX_VNORM)) or
+				(component == 2 and (faceType == VERTEX or faceType == VERTEX_TEXT)))
 				continue;
-			uint32_t toInsert = this->_parseUint(strNumber);
-			if (toInsert == 0UL)
-				throw ParsingException("Face index value 0 in line: 'f " + content + "', has to be at least 1");
-			// face indexes start at 1, hence the -1
-			coorList.push_back(toInsert - 1);
+			else if (value == 0)
+				throw ParsingException("Face index value 0 in line: 'f " + std::string(content) + "', has to be at least 1");
+			else if (value > 0) {
+				// face indexes start at 1, hence the -1
+				coorList[component] = static_cast<uint32_t>(value - 1);
+				continue;
+			}
+			// negative indexes count backwards from the last element parsed so far
+			std::array<size_t,3> counts{data._vertexes.size(), data._textures.size(), data._normals.size()};
+			int64_t resolved = static_cast<int64_t>(counts[component]) + value;
+			if (this->_isChunk) {
+				// the chunk doesn't know how many elements come before it, resolved when merging
+				this->_relativeIndexes.push_back(RelativeIndex{data._faces.size(), static_cast<uint32_t>(indexList.size()), component, resolved, static_cast<int32_t>(value)});
+				resolved = 0;
+			}
+			else if (resolved < 0)
+				throw ParsingException("Relative face index out of range: " + std::to_string(value));
+			coorList[component] = static_cast<uint32_t>(resolved);
 		}
-		VectUI3 vertexIndex = VectUI3::from_vector(coorList);
-		// swap the two indexes so that the norm index is always the third in the index struct
-		if (faceType == VERTEX_VNORM)
-			std::swap(vertexIndex.i2, vertexIndex.i3);
-		indexList.push_back(vertexIndex);
+		indexList.push_back(VectUI3::from_array(coorList));
 	}
 	if (indexList.size() < 3)
-		throw ParsingException("Not enought face coordinates provided, minimum 3: " + content);
-
-	Face newFace(static_cast<FaceType>(faceType), indexList);
-	if (this->_currentObject != "")
-		newFace.setObject(this->_currentObject);
-	if (this->_currentGroup != "")
-		newFace.setGroup(this->_currentGroup);
-	if (this->_currentMaterial != "")
-		newFace.setMaterial(this->_currentMaterial);
-	if (this->_currentSmoothing != 0)
-		newFace.setSmoothing(this->_currentSmoothing);
-	return newFace;
+		throw ParsingException("Not enought face coordinates provided, minimum 3: " + std::string(content));
+
+	FaceAttributes attributes{this->_currentObject, this->_currentGroup, this->_currentMaterial, this->_currentSmoothing};
+	data._faces.push(static_cast<FaceType>(faceType), indexList.data(), static_cast<uint32_t>(indexList.size()), attributes);
 }
 
-Line FileParser::_createLine( std::string const& content ) const {
-	std::stringstream ss(content);
+Line FileParser::_createLine( std::string_view content, ParsedData const& data ) const {
+	std::string_view remaining = content;
 	std::vector<uint32_t> indexList;
-	std::string index;
+	std::string_view index;
 
-	while (ss >> index)
+	while (!(index = nextToken(remaining)).empty())
 		indexList.push_back(this->_parseUint(index));
 
+	StringTable const& names = data._faces.getNames();
 	Line newLine(indexList);
-	if (this->_currentObject != "")
-		newLine.setObject(this->_currentObject);
-	if (this->_currentGroup != "")
-		newLine.setGroup(this->_currentGroup);
-	if (this->_currentMaterial != "")
-		newLine.setMaterial(this->_currentMaterial);
+	if (this->_currentObject != 0U)
+		newLine.setObject(names.getName(this->_currentObject));
+	if (this->_currentGroup != 0U)
+		newLine.setGroup(names.getName(this->_currentGroup));
+	if (this->_currentMaterial != 0U)
+		newLine.setMaterial(names.getName(this->_currentMaterial));
 	if (this->_currentSmoothing != 0)
 		newLine.setSmoothing(this->_currentSmoothing);
 	return newLine;
 }
 
-std::string FileParser::_trimString( std::string const& content ) const noexcept {
-	size_t spacePos = content.find(' ');
-	if (spacePos == std::string::npos)
-		return content;
-	else if (content == " ")
-		return "";
-
-	bool trimmed = false;
-	uint32_t leftTrim = 0;
-	uint32_t rightTrim = content.size() - 1;
-	while (content[leftTrim] == ' ' or content[rightTrim] == ' ') {
-		trimmed = true;
-		if (content[leftTrim] == ' ')
-			leftTrim++;
-		if (content[rightTrim] == ' ')
-			rightTrim--;
-		if (leftTrim <= rightTrim)
-			break;
-	}
-	if (trimmed)
-		return content.substr(leftTrim, rightTrim + 1);
-	else
-		return content;
-}
-
-FaceType FileParser::_getFaceType( std::string const& content ) const noexcept {
-	size_t firstSlashPos, secondSlashPos;
-	firstSlashPos = content.find("/");
-	if (firstSlashPos == std::string::npos)
-		return VERTEX;
-	else {
-		secondSlashPos = content.find("/", firstSlashPos + 1);
-		if (secondSlashPos == firstSlashPos + 1)
-			return VERTEX_VNORM;
-		else if (secondSlashPos == std::string::npos)
-			return VERTEX_TEXT;
-		else
-			return VERTEX_TEXT_VNORM;
-	}
+void FileParser::_reportProgress( ParsedData const& data ) {
+	if (!this->_progress or data._faces.size() == this->_reportedFaces)
+		return;
+	size_t firstFace = this->_reportedFaces;
+	this->_reportedFaces = data._faces.size();
+	this->_progress(data, firstFace);
 }
 
-float FileParser::_parseFloat( std::string const& strNumber ) const {
-	try {
-		return std::stof(strNumber);
-	}
-	catch (std::invalid_argument const& e) {
-		throw ParsingException("Invalid number parsed: " + strNumber);
-	}
-	catch (std::out_of_range const& e) {
-		throw ParsingException("Invalid number parsed, overflow: " + strNumber);
-	}
-}
+uint32_t FileParser::_parseUint( std::string_view strNumber ) const {
+	if (strNumber.size() > 0 and strNumber[0] == '-')
+		throw ParsingException("Negative number parsed: " + std::string(strNumber));
 
-int32_t FileParser::_parseInt( std::string const& strNumber ) const {
-	try {
-		return std::stoi(strNumber);
-	}
-	catch (std::invalid_argument const& e) {
-		throw ParsingException("Invalid number parsed: " + strNumber);
-	}
-	catch (std::out_of_range const& e) {
-		throw ParsingException("Invalid number parsed, overflow: " + strNumber);
-	}
-}
+	std::string_view digits = strNumber;
+	if (digits.size() > 1 and digits[0] == '+')
+		digits.remove_prefix(1);
 
-uint32_t FileParser::_parseUint( std::string const& strNumber ) const {
-	try {
-		if (strNumber.size() > 0 and strNumber[0] == '-')
-			throw ParsingException("Negative number parsed: " + strNumber);
-		return std::stoul(strNumber);
-	}
-	catch (std::invalid_argument const& e) {
-		throw ParsingException("Invalid number parsed: " + strNumber);
-	}
-	catch (std::out_of_range const& e) {
-		throw ParsingException("Invalid number parsed, overflow: " + strNumber);
-	}
+	uint32_t number = 0U;
+	std::from_chars_result result = std::from_chars(digits.data(), digits.data() + digits.size(), number);
+	if (result.ec == std::errc::invalid_argument)
+		throw ParsingException("Invalid number parsed: " + std::string(strNumber));
+	else if (result.ec == std::errc::result_out_of_range)
+		throw ParsingException("Invalid number parsed, overflow: " + std::string(strNumber));
+	return number;
 }
@@ -0,0 +1,141 @@
+#ifdef SCOP_PROFILE
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include "profiler.hpp"
+#include "define.hpp"
+#include "exception.hpp"
+
+
+namespace {
+	struct TraceEvent {
+		char const*	name;
+		int64_t		start;
+		int64_t		end;
+	};
+
+	// every thread appends to its own events: the mutex is only contended by the writer at the end
+	struct ThreadTrace {
+		std::mutex				mutex;
+		uint32_t				id;
+		std::string				name;
+		std::vector<TraceEvent>	events;
+		uint64_t				dropped = 0U;
+	};
+
+	std::atomic<bool> recording{false};
+	std::chrono::steady_clock::time_point startTime;
+	// kept after their thread ends, the loader and the pool workers don't live until the file is written
+	std::mutex threadsMutex;
+	std::vector<std::unique_ptr<ThreadTrace>> threads;
+	thread_local ThreadTrace* currentThread = nullptr;
+
+	ThreadTrace& getThreadTrace( void ) {
+		if (currentThread == nullptr) {
+			std::lock_guard<std::mutex> lock(threadsMutex);
+			threads.push_back(std::make_unique<ThreadTrace>());
+			currentThread = threads.back().get();
+			currentThread->id = static_cast<uint32_t>(threads.size());
+		}
+		return *currentThread;
+	}
+
+	void writeString( std::ostream& os, std::string const& string ) {
+		os << '"';
+		for (char c : string) {
+			if (c == '"' or c == '\\')
+				os << '\\';
+			os << (static_cast<unsigned char>(c) < 0x20 ? ' ' : c);
+		}
+		os << '"';
+	}
+}
+
+Profiler::Profiler( std::string const& traceFile ) : _traceFile(traceFile) {
+	if (recording.load())
+		throw AppException("Profiler already recording");
+	startTime = std::chrono::steady_clock::now();
+	SCOP_THREAD_NAME("main");
+	recording.store(true);
+}
+
+Profiler::~Profiler( void ) noexcept {
+	recording.store(false);
+	try {
+		this->_write();
+	} catch (std::exception const& error) {
+		std::cerr << error.what() << std::endl;
+	}
+}
+
+bool Profiler::isRecording( void ) noexcept {
+	return recording.load(std::memory_order_acquire);
+}
+
+int64_t Profiler::now( void ) noexcept {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Profiler::record( char const* name, int64_t start, int64_t end ) noexcept {
+	try {
+		ThreadTrace& thread = getThreadTrace();
+		std::lock_guard<std::mutex> lock(thread.mutex);
+		// a long session in the render loop doesn't grow without limit
+		if (thread.events.size() >= SCOP_TRACE_MAX_EVENTS)
+			thread.dropped++;
+		else
+			thread.events.push_back(TraceEvent{name, start, end});
+	} catch (...) {
+		// out of memory: the zone is lost, not the program
+	}
+}
+
+void Profiler::nameThread( std::string const& name ) noexcept {
+	try {
+		ThreadTrace& thread = getThreadTrace();
+		std::lock_guard<std::mutex> lock(thread.mutex);
+		thread.name = name;
+	} catch (...) {
+		// the thread is shown with its number
+	}
+}
+
+void Profiler::_write( void ) const {
+	std::ofstream file(this->_traceFile);
+	if (!file)
+		throw AppException("Couldn't write trace file: " + this->_traceFile);
+
+	// "X": complete event, timestamps and durations in microseconds
+	size_t nEvents = 0U;
+	uint64_t dropped = 0U;
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::fixed << std::setprecision(3);
+	std::lock_guard<std::mutex> threadsLock(threadsMutex);
+	for (std::unique_ptr<ThreadTrace> const& thread : threads) {
+		std::lock_guard<std::mutex> lock(thread->mutex);
+		file << (thread->id > 1 ? ",\n" : "\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread->id << ",\"args\":{\"name\":";
+		writeString(file, thread->name.empty() ? "thread " + std::to_string(thread->id) : thread->name);
+		file << "}}";
+		for (TraceEvent const& event : thread->events) {
+			file << ",\n{\"ph\":\"X\",\"name\":";
+			writeString(file, event.name);
+			file << ",\"pid\":1,\"tid\":" << thread->id << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+		}
+		nEvents += thread->events.size();
+		dropped += thread->dropped;
+	}
+	file << "\n]}\n";
+	if (!file)
+		throw AppException("Couldn't write trace file: " + this->_traceFile);
+	std::cout << "trace: " << nEvents << " zones of " << threads.size() << " threads written to " << this->_traceFile;
+	if (dropped > 0)
+		std::cout << " (" << dropped << " dropped)";
+	std::cout << std::endl;
+}
+
+#endif
@@ -1,16 +1,41 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <future>
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <cstdlib>
+#include <cmath>
+#include <cstddef>
 #include <glad/glad.h> 
 
 #include "scop.hpp"
 #include "parser.hpp"
+#include "meshCache.hpp"
 #include "exception.hpp"
+#include "memoryStats.hpp"
+#include "profiler.hpp"
 #include "math/quaternion.hpp"
 #include "math/utilities.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+// compressed formats from the extensions, not in the glad core 3.3 header
+static constexpr GLenum GL_COMPRESSED_RGBA_S3TC_DXT1_EXT = 0x83F1;
+static constexpr GLenum GL_COMPRESSED_RGBA_S3TC_DXT5_EXT = 0x83F3;
+static constexpr GLenum GL_COMPRESSED_RGBA_BPTC_UNORM = 0x8E8C;
+
+// RGBA8 color of a preview vertex, from its index: the same colors on every run
+static uint32_t previewColor( size_t index ) noexcept {
+	uint32_t hash = static_cast<uint32_t>(index) * 2654435761U;
+	return (hash ^ (hash >> 15)) | 0xff000000U;
+}
 
 
 GraphicGL::GraphicGL( GLuint shader, std::string const& uniformName ) {
@@ -36,6 +61,10 @@ void GraphicGL::reset( void ) noexcept {
 	this->_transformation = idMat();
 }
 
+Matrix4 const& GraphicGL::getTransformation( void ) const noexcept {
+	return this->_transformation;
+}
+
 
 void ModelGL::rotate( float pitch, float yaw, float roll ) noexcept {
 	pitch = toRadiants(pitch / 2.0f);	// vertical rotation: cameraLeft is the axis
@@ -61,6 +90,11 @@ void ModelGL::scale( VectF3 const& scale ) noexcept {
 	GraphicGL::updateShader();
 }
 
+void ModelGL::setTransformation( Matrix4 const& transformation ) noexcept {
+	this->_transformation = transformation;
+	GraphicGL::updateShader();
+}
+
 
 void CameraGL::moveForward( float delta ) noexcept {
 	this->_position -= this->_cameraForward * delta;
@@ -139,6 +173,17 @@ void CameraGL::updateShader( void ) {
 	GraphicGL::updateShader();
 }
 
+CameraState CameraGL::getState( void ) const noexcept {
+	return CameraState{this->_position, this->_forward, this->__up};
+}
+
+void CameraGL::setState( CameraState const& state ) noexcept {
+	this->_position = state.position;
+	this->_forward = state.forward;
+	this->__up = state.up;
+	this->updateShader();
+}
+
 void ProjectionGL::setAspect( uint32_t width, uint32_t height ) noexcept {
 	this->_aspect = static_cast<float>(width) / static_cast<float>(height);
 	this->updateShader();
@@ -171,12 +216,29 @@ void ProjectionGL::updateShader( void ) {
 
 
 ScopGL::~ScopGL( void ) noexcept {
+	// the loader stops at the next chunk, a parse already started is finished
+	this->_stopLoading = true;
+	if (this->_loader.joinable())
+		this->_loader.join();
 	if (this->_VBO)
 		glDeleteVertexArrays(1, &this->_VBO);
 	if (this->_VAO)
 		glDeleteBuffers(1, &this->_VAO);
 	if (this->_EBO)
 		glDeleteBuffers(1, &this->_EBO);
+	this->_deletePreview();
+	for (GLuint texture : this->_materialTextures) {
+		if (texture != this->_texture)
+			glDeleteTextures(1, &texture);
+	}
+	if (this->_texture)
+		glDeleteTextures(1, &this->_texture);
+	if (this->_pixelBuffer)
+		glDeleteBuffers(1, &this->_pixelBuffer);
+	if (this->_framebuffer) {
+		glDeleteFramebuffers(1, &this->_framebuffer);
+		glDeleteRenderbuffers(2, this->_renderbuffers.data());
+	}
 	if (this->_shaderProgram)
 		glDeleteProgram(this->_shaderProgram);
 	if (this->_window)
@@ -184,21 +246,18 @@ ScopGL::~ScopGL( void ) noexcept {
 	glfwTerminate();
 }
 
-void ScopGL::parseFile( std::string const& fileName ) {
-	FileParser parser;
-	ParsedData data = parser.parse(fileName);
-
-	data.triangolate();
-	data.fixTrianglesOrientation();
-	data.fillTexturesAndNormals();
-	data.fillBuffers();
-	this->_VBOdata = data.getVBO();
-	if (data.hasFaces())
-		this->_EBOdata = data.getEBO();
-	std::cout << "parsed file " << fileName << std::endl;
+void ScopGL::parseFile( std::string const& fileName, uint32_t threads, bool useCache, bool optimize, bool packVertexes ) {
+	if (this->_loader.joinable() or this->_VBOdata)
+		throw AppException("Object file already loaded");
+	this->_loader = std::thread(&ScopGL::_loadFile, this, fileName, threads, useCache, optimize, packVertexes);
 }
 
-void ScopGL::createWindow( int32_t width, int32_t height ) {
+void ScopGL::createWindow( int32_t width, int32_t height, bool visible ) {
+	SCOP_ZONE("ScopGL::createWindow");
+	// no display (CI boxes): the null platform of glfw renders with OSMesa, llvmpipe on the CPU
+	bool headless = !visible and !std::getenv("DISPLAY") and !std::getenv("WAYLAND_DISPLAY");
+	if (headless)
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
 	if (this->_window)
 		throw AppException("Window already initialized");
 	else if (width < 0 or height < 0)
@@ -213,22 +272,27 @@ void ScopGL::createWindow( int32_t width, int32_t height ) {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+	if (headless)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
 	this->_window = glfwCreateWindow(width, height, "SCOP", nullptr, nullptr);
 	if (!this->_window) {
 		const char* description;
 		glfwGetError(&description);
 		throw GlfwException("Creation of window failed: " + std::string(description));
 	}
-	std::cout << "created window " << width << "x" << height << "p" << std::endl;
+	std::cout << "created " << (visible ? "window " : headless ? "hidden window (no display) " : "hidden window ") << width << "x" << height << "p" << std::endl;
 
 	// save a reference of Scop inside GLFW
 	glfwSetWindowUserPointer(this->_window, this);
 
 	// center the window
-	const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
-	int32_t posX = (mode->width - width) / 2;
-	int32_t posY = (mode->height - height) / 2;
-	glfwSetWindowPos(this->_window, posX, posY);
+	if (visible) {
+		const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+		int32_t posX = (mode->width - width) / 2;
+		int32_t posY = (mode->height - height) / 2;
+		glfwSetWindowPos(this->_window, posX, posY);
+	}
 
 	glfwMakeContextCurrent(this->_window);
 
@@ -240,6 +304,7 @@ void ScopGL::createWindow( int32_t width, int32_t height ) {
 }
 
 void ScopGL::initGL( std::string const& vertexShaderSource, std::string const& textureShaderSource, std::string const& textureFile ) {
+	SCOP_ZONE("ScopGL::initGL");
 	if (!this->_window)
 		throw AppException("GLFW not started, call .createWindow()");
 	else if (this->_shaderProgram)
@@ -260,11 +325,10 @@ void ScopGL::initGL( std::string const& vertexShaderSource, std::string const& t
 	this->_createShader(GL_FRAGMENT_SHADER, textureShaderSource);
 	std::cout << "loaded fragment shader: " << textureShaderSource << std::endl;
 
-	this->_loadTexture(textureFile);
-	std::cout << "loaded texture: " << textureFile << std::endl;
-
-	this->_loadBuffersInGPU();
-	std::cout << "VBO uploaded to GPU" << std::endl;
+	this->_detectTextureCompression();
+	this->_texture = this->_loadTexture(textureFile);
+	this->_blendingUniform = glGetUniformLocation(this->_shaderProgram, "blendingLevel");
+	std::cout << "loading texture: " << textureFile << std::endl;
 
 	this->_model = std::make_unique<ModelGL>(this->_shaderProgram);
 	this->_camera = std::make_unique<CameraGL>(this->_shaderProgram, VectF3{0.0f, 0.0f, SCOP_CAMERA_DISTANCE});
@@ -274,7 +338,7 @@ void ScopGL::initGL( std::string const& vertexShaderSource, std::string const& t
 void ScopGL::loop( void ) {
 	if (!this->_window)
 		throw AppException("GLFW not started, call .createWindow()");
-	else if (!this->_VBOdata)
+	else if (!this->_loader.joinable() and !this->_VBOdata)
 		throw AppException("Data not parsed, call .parseFile()");
 	else if (!this->_shaderProgram)
 		throw AppException("OpenGL not started, call .initGL()");
@@ -292,26 +356,130 @@ void ScopGL::loop( void ) {
 	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 
 	this->_centerCursor();
+	if (this->_replay)
+		std::cout << "replaying " << this->_replay->size() << " frames (" << this->_replay->getDuration() << "s)" << std::endl;
 	std::cout << "starting loop" << std::endl;
+	double startTime = glfwGetTime();
+	this->_lastFrameTime = startTime;
+	uint64_t nFrames = 0U;
 	while (!glfwWindowShouldClose(this->_window)) {
+		SCOP_ZONE("frame");
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glBindTexture(GL_TEXTURE_2D, this->_texture);
+		this->_receiveChunks();
+		this->_receiveTextures();
 		glBindVertexArray(this->_VAO);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->_EBO);
 
-		this->_moveCamera();
+		if (this->_replay) {
+			// a fixed step of the recording per frame, however long the frames take: the same frames on every run.
+			// what the input changes is overwritten here
+			double time = static_cast<double>(nFrames++) * SCOP_REPLAY_TIMESTEP;
+			if (time > this->_replay->getDuration())
+				break;
+			this->_setFrameState(this->_replay->at(time));
+		} else {
+			this->_moveCamera();
+			if (this->_isFading)
+				this->_fading();
+		}
+		if (this->_recordFile.empty() == false)
+			this->_recording.push(this->_getFrameState(glfwGetTime() - startTime));
 
-		if (this->_isFading)
-			this->_fading();
-
-		if (this->_EBO)
-			glDrawElements(GL_TRIANGLES, this->_EBOdata->size, GL_UNSIGNED_INT, 0);
-		else
-			glDrawArrays(GL_TRIANGLES, 0, this->_VBOdata->size);
+		this->_draw();
 
+		// waits for the vsync: the cpu side of the frame is the time before it
+		SCOP_ZONE("swap buffers");
 		glfwSwapBuffers(this->_window);
 		glfwPollEvents();
 	}
+
+	if (this->_recordFile.empty() == false) {
+		this->_recording.save(this->_recordFile);
+		std::cout << "camera path: " << this->_recording.size() << " frames (" << this->_recording.getDuration() << "s) written to " << this->_recordFile << std::endl;
+	}
+}
+
+void ScopGL::benchmark( uint32_t frames ) {
+	if (!this->_window)
+		throw AppException("GLFW not started, call .createWindow()");
+	else if (!this->_loader.joinable() and !this->_VBOdata)
+		throw AppException("Data not parsed, call .parseFile()");
+	else if (!this->_shaderProgram)
+		throw AppException("OpenGL not started, call .initGL()");
+
+	glUseProgram(this->_shaderProgram);
+	this->_model->updateShader();
+	this->_camera->updateShader();
+	this->_projection->updateShader();
+
+	// the timed frames draw the whole mesh with its textures
+	auto startLoading = std::chrono::steady_clock::now();
+	this->_waitForMesh();
+	auto elapsedLoading = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startLoading);
+	std::cout << "mesh and textures uploaded in " << elapsedLoading.count() << "ms" << std::endl;
+
+	this->_createFramebuffer();
+	glViewport(0, 0, this->_widthWindow, this->_heightWindow);
+	glEnable(GL_DEPTH_TEST);
+	glFrontFace(GL_CCW);
+	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+	glBindVertexArray(this->_VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->_EBO);
+
+	std::vector<double> times;
+	times.reserve(frames);
+	uint32_t drawCalls = 0U;
+	for (uint32_t i=0; i<SCOP_BENCH_WARMUP_FRAMES + frames; i++) {
+		SCOP_ZONE("benchmark frame");
+		bool timed = i >= SCOP_BENCH_WARMUP_FRAMES;
+		auto start = std::chrono::steady_clock::now();
+		if (this->_replay)
+			this->_setFrameState(this->_replay->at(timed ? static_cast<double>(i - SCOP_BENCH_WARMUP_FRAMES) * SCOP_REPLAY_TIMESTEP : 0.0));
+		else
+			this->_scriptFrame(timed ? static_cast<float>(i - SCOP_BENCH_WARMUP_FRAMES) / static_cast<float>(frames) : 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		drawCalls = this->_draw();
+		// a frame is over when the GPU is done with it, not when its calls are queued
+		glFinish();
+		if (timed)
+			times.push_back(std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// nearest rank
+	std::vector<double> sorted = times;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&sorted]( double rank ) {
+		size_t index = static_cast<size_t>(std::ceil(rank * sorted.size()));
+		return sorted[std::clamp<size_t>(index, 1, sorted.size()) - 1];
+	};
+	double total = 0.0;
+	for (double time : times)
+		total += time;
+	double mean = total / times.size();
+	uint64_t triangles = (this->_EBO ? this->_uploadedIndexes : this->_uploadedVertexes) / 3U;
+	double trianglesPerSecond = total > 0.0 ? static_cast<double>(triangles) * times.size() / (total / 1000.0) : 0.0;
+	char const* renderer = reinterpret_cast<char const*>(glGetString(GL_RENDERER));
+
+	char const* path = this->_replay ? "replay" : "scripted";
+
+	std::cout << "benchmark: " << frames << " frames (" << path << " path) " << this->_widthWindow << "x" << this->_heightWindow << " on " << renderer << ", frame time mean " <<
+		mean << "ms, p50 " << percentile(0.5) << "ms, p99 " << percentile(0.99) << "ms, " << drawCalls << " draw calls, " << triangles <<
+		" triangles per frame, " << trianglesPerSecond / 1e6 << "M triangles/s" << std::endl;
+	// one line to diff between runs
+	std::cout << std::fixed << std::setprecision(3) << "{\"frames\":" << frames << ",\"width\":" << this->_widthWindow << ",\"height\":" <<
+		this->_heightWindow << ",\"renderer\":\"" << renderer << "\",\"mean_ms\":" << mean << ",\"p50_ms\":" << percentile(0.5) <<
+		",\"p99_ms\":" << percentile(0.99) << ",\"path\":\"" << path << "\",\"draw_calls\":" << drawCalls << ",\"triangles\":" << triangles << std::setprecision(0) <<
+		",\"triangles_per_s\":" << trianglesPerSecond << "}" << std::defaultfloat << std::endl;
+}
+
+void ScopGL::recordPath( std::string const& fileName ) {
+	this->_recordFile = fileName;
+	this->_recording = CameraPath();
+}
+
+void ScopGL::replayPath( std::string const& fileName ) {
+	this->_replay = CameraPath::load(fileName);
 }
 
 void ScopGL::resetCanvaSize( uint32_t width, uint32_t height ) {
@@ -379,23 +547,208 @@ uint32_t ScopGL::_loadShader( GLenum type, std::string const& fileName ) {
 	return shaderRef;
 }
 
-void ScopGL::_loadTexture( std::string const& texturePath ) {
-	glGenTextures(1, &this->_texture);
-	glBindTexture(GL_TEXTURE_2D, this->_texture);
+GLuint ScopGL::_loadTexture( std::string const& texturePath ) {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-	int32_t width, height, nrChannels;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// grey placeholder until the image is decoded, the faces are drawn with their colors meanwhile
+	std::array<unsigned char,4> placeholder{128, 128, 128, 255};
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	// the .dds made by scop_texconv has the mips already, and is compressed if the driver samples it
+	fs::path ddsPath = fs::path(texturePath).replace_extension(".dds");
+	std::error_code error;
+	bool useDDS = ddsPath != fs::path(texturePath) and fs::exists(ddsPath, error) and
+		fs::last_write_time(ddsPath, error) >= fs::last_write_time(texturePath, error) and !error;
+
+	// the flag is global in stb_image: set here, before the worker reads it
 	stbi_set_flip_vertically_on_load(true);
-	unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0);
-	if (!data)
-		throw OpenGlException("Failed to load texture in: " + texturePath);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-	glGenerateMipmap(GL_TEXTURE_2D);
-	
-	stbi_image_free(data);
+	bool supportsS3TC = this->_supportsS3TC, supportsBPTC = this->_supportsBPTC;
+	std::future<Texture> image = std::async(std::launch::async, [texturePath, ddsPath, useDDS, supportsS3TC, supportsBPTC]() {
+		SCOP_THREAD_NAME("texture decoder");
+		SCOP_ZONE("decode texture");
+		if (useDDS) {
+			Texture container = readDDS(ddsPath.string());
+			if ((container.format == TextureFormat::BC1 or container.format == TextureFormat::BC3) and !supportsS3TC)
+				container = decompressTexture(container);
+			// BC7 isn't decoded on the CPU: without BPTC the source image is read instead
+			if (container.format != TextureFormat::BC7 or supportsBPTC)
+				return container;
+		}
+		// always 4 channels: RGBA images (png) and RGB ones are uploaded the same way
+		int32_t width, height, channels;
+		unsigned char* pixels = stbi_load(texturePath.c_str(), &width, &height, &channels, 4);
+		if (!pixels)
+			throw OpenGlException("Failed to load texture in: " + texturePath);
+		Texture decoded;
+		decoded.levels.push_back(TextureLevel{static_cast<uint32_t>(width), static_cast<uint32_t>(height), 0U,
+			static_cast<size_t>(width) * height * 4});
+		decoded.data.assign(pixels, pixels + decoded.levels[0].size);
+		stbi_image_free(pixels);
+		return decoded;
+	});
+	this->_pendingTextures.push_back(PendingTexture{texture, useDDS ? ddsPath.string() : texturePath, std::move(image)});
+	return texture;
+}
+
+void ScopGL::_receiveTextures( void ) {
+	for (auto it = this->_pendingTextures.begin(); it != this->_pendingTextures.end(); it++) {
+		if (it->image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			continue;
+		PendingTexture pending = std::move(*it);
+		this->_pendingTextures.erase(it);
+		try {
+			Texture image = pending.image.get();
+			this->_uploadTexture(pending.texture, image);
+			std::cout << "loaded texture: " << pending.path << " (" << formatToString(image.format) << ", " <<
+				image.levels.size() << " mips, " << image.data.size() / 1024 << " KB)" << std::endl;
+		} catch (AppException const& error) {
+			// the default texture is needed, a material falls back to it
+			if (pending.texture == this->_texture)
+				throw;
+			std::cerr << error.what() << ", using the default texture" << std::endl;
+			std::replace(this->_materialTextures.begin(), this->_materialTextures.end(), pending.texture, this->_texture);
+			glDeleteTextures(1, &pending.texture);
+		}
+		// one upload per frame
+		return;
+	}
+}
+
+void ScopGL::_uploadTexture( GLuint texture, Texture const& image ) {
+	SCOP_ZONE("ScopGL::_uploadTexture");
+	// the pixels go through a pixel buffer object: glTexImage2D returns without waiting for the copy
+	if (this->_pixelBuffer == 0U)
+		glGenBuffers(1, &this->_pixelBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->_pixelBuffer);
+	// new storage every time: no wait on a transfer still reading the previous one
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, image.data.size(), nullptr, GL_STREAM_DRAW);
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, image.data.size(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (!mapped) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		throw OpenGlException("Failed to map the pixel buffer");
+	}
+	std::memcpy(mapped, image.data.data(), image.data.size());
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	GLenum compressedFormat = image.format == TextureFormat::BC1 ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT :
+		image.format == TextureFormat::BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_BPTC_UNORM;
+	for (size_t i=0; i<image.levels.size(); i++) {
+		TextureLevel const& level = image.levels[i];
+		void const* offset = reinterpret_cast<void const*>(level.offset);
+		if (isCompressed(image.format))
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, compressedFormat, level.width, level.height, 0, level.size, offset);
+		else
+			glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, offset);
+	}
+	// a decoded image has only level 0, a container brings its own mips. the driver can't build the mips
+	// of a compressed image: one without them is sampled from level 0 only
+	bool generateMips = image.levels.size() == 1 and image.format == TextureFormat::RGBA8;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, generateMips ? 1000 : static_cast<GLint>(image.levels.size() - 1));
+	if (generateMips)
+		glGenerateMipmap(GL_TEXTURE_2D);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void ScopGL::_detectTextureCompression( void ) {
+	GLint major, minor, nExtensions;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	glGetIntegerv(GL_NUM_EXTENSIONS, &nExtensions);
+	// BPTC is core since 4.2
+	this->_supportsBPTC = major > 4 or (major == 4 and minor >= 2);
+	for (GLint i=0; i<nExtensions; i++) {
+		std::string_view extension = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, i));
+		if (extension == "GL_EXT_texture_compression_s3tc")
+			this->_supportsS3TC = true;
+		else if (extension == "GL_ARB_texture_compression_bptc")
+			this->_supportsBPTC = true;
+	}
+	std::cout << "compressed textures: S3TC " << (this->_supportsS3TC ? "yes" : "no") << ", BPTC " <<
+		(this->_supportsBPTC ? "yes" : "no") << std::endl;
+}
+
+bool ScopGL::_isTextureReady( GLuint texture ) const noexcept {
+	return std::none_of(this->_pendingTextures.cbegin(), this->_pendingTextures.cend(), [texture]( PendingTexture const& pending ) {
+		return pending.texture == texture;
+	});
+}
+
+void ScopGL::_loadMaterials( void ) {
+	// a texture used by more materials is loaded once, a map that can't be decoded falls back to the default texture
+	std::map<fs::path,GLuint> loaded;
+	this->_materialTextures.assign(this->_materials.size(), this->_texture);
+	for (size_t i=0; i<this->_materials.size(); i++) {
+		fs::path const& diffuseMap = this->_materials[i].diffuseMap;
+		if (diffuseMap.empty())
+			continue;
+		auto it = loaded.find(diffuseMap);
+		if (it == loaded.end())
+			it = loaded.emplace(diffuseMap, this->_loadTexture(diffuseMap.string())).first;
+		this->_materialTextures[i] = it->second;
+	}
+
+	this->_materialUniforms.useMaterial = glGetUniformLocation(this->_shaderProgram, "useMaterial");
+	this->_materialUniforms.ambient = glGetUniformLocation(this->_shaderProgram, "ambientColor");
+	this->_materialUniforms.diffuse = glGetUniformLocation(this->_shaderProgram, "diffuseColor");
+	this->_materialUniforms.specular = glGetUniformLocation(this->_shaderProgram, "specularColor");
+	this->_materialUniforms.shininess = glGetUniformLocation(this->_shaderProgram, "shininess");
+}
+
+uint32_t ScopGL::_draw( void ) {
+	SCOP_ZONE("ScopGL::_draw");
+	if (this->_previewVAO and this->_isMeshUploaded() == false)
+		return this->_drawPreview();
+	else if (!this->_VBO)
+		return 0U;
+	else if (!this->_EBO) {
+		glBindTexture(GL_TEXTURE_2D, this->_texture);
+		glUniform1i(this->_materialUniforms.useMaterial, GL_FALSE);
+		glUniform1f(this->_blendingUniform, this->_isTextureReady(this->_texture) ? this->_blendingLevel : 0.0f);
+		glDrawArrays(GL_TRIANGLES, 0, this->_uploadedVertexes);
+		return 1U;
+	}
+
+	// ranges with the same texture are adjacent: the texture is bound only when it changes
+	GLenum indexType = this->_EBOdata->stride == EBO_SHORT_STRIDE ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	GLuint boundTexture = 0U;
+	float blendingLevel = -1.0f;
+	uint32_t drawCalls = 0U;
+	for (DrawRange const& range : this->_EBOdata->ranges) {
+		// while loading only the triangles already uploaded
+		if (range.first >= this->_uploadedIndexes)
+			break;
+		uint32_t count = std::min(range.count, this->_uploadedIndexes - range.first);
+		GLuint texture = this->_materialTextures[range.material];
+		if (texture != boundTexture) {
+			glBindTexture(GL_TEXTURE_2D, texture);
+			boundTexture = texture;
+			// color only until the texture is uploaded
+			float rangeBlending = this->_isTextureReady(texture) ? this->_blendingLevel : 0.0f;
+			if (rangeBlending != blendingLevel) {
+				glUniform1f(this->_blendingUniform, rangeBlending);
+				blendingLevel = rangeBlending;
+			}
+		}
+		Material const& material = this->_materials[range.material];
+		glUniform1i(this->_materialUniforms.useMaterial, range.material != 0U);
+		glUniform3f(this->_materialUniforms.ambient, material.ambient.x, material.ambient.y, material.ambient.z);
+		glUniform3f(this->_materialUniforms.diffuse, material.diffuse.x, material.diffuse.y, material.diffuse.z);
+		glUniform3f(this->_materialUniforms.specular, material.specular.x, material.specular.y, material.specular.z);
+		glUniform1f(this->_materialUniforms.shininess, material.shininess);
+		glDrawElements(GL_TRIANGLES, count, indexType, reinterpret_cast<void*>(static_cast<uintptr_t>(range.first) * this->_EBOdata->stride));
+		drawCalls++;
+	}
+	return drawCalls;
 }
 
 void ScopGL::_setupCallbacks( void ) {
@@ -440,6 +793,7 @@ void ScopGL::_setupCallbacks( void ) {
 }
 
 void ScopGL::_loadBuffersInGPU( void ) {
+	SCOP_ZONE("ScopGL::_loadBuffersInGPU");
 	if (!this->_window)
 		throw AppException("GLFW not started, call .createWindow()");
 	else if (!this->_VBOdata)
@@ -454,41 +808,316 @@ void ScopGL::_loadBuffersInGPU( void ) {
 	glBindVertexArray(this->_VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, this->_VBO);
 
-	// load vertex data
-	glBufferData(GL_ARRAY_BUFFER, this->_VBOdata->size * this->_VBOdata->stride, this->_VBOdata->getData(), GL_STATIC_DRAW);
+	// storage for the whole mesh, filled chunk by chunk
+	glBufferData(GL_ARRAY_BUFFER, static_cast<size_t>(this->_VBOdata->size) * this->_VBOdata->stride, nullptr, GL_STATIC_DRAW);
 	// vertex metadata in VAO
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)0);
 	glEnableVertexAttribArray(0);
-	// texture metadata in VAO
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)(3 * sizeof(float)));
+	if (this->_VBOdata->format == VERTEX_PACKED) {
+		// texture metadata in VAO: 2 half floats
+		glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)(3 * sizeof(float)));
+		// normals metadata in VAO: signed normalized 10_10_10_2
+		glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, this->_VBOdata->stride, (void*)(4 * sizeof(float)));
+		// color metadata in VAO: normalized RGBA8
+		glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, this->_VBOdata->stride, (void*)(5 * sizeof(float)));
+	} else {
+		// texture metadata in VAO
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)(3 * sizeof(float)));
+		// normals metadata in VAO
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)(5 * sizeof(float)));
+		// color metadata in VAO
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)(8 * sizeof(float)));
+	}
 	glEnableVertexAttribArray(1);
-	// normals metadata in VAO
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)(5 * sizeof(float)));
 	glEnableVertexAttribArray(2);
-	// color metadata in VAO
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, this->_VBOdata->stride, (void*)(8 * sizeof(float)));
 	glEnableVertexAttribArray(3);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	if (this->_EBOdata) {
-		// load face indexes data
+		// face indexes storage
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->_EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->_EBOdata->size * this->_EBOdata->stride, this->_EBOdata->getData(), GL_STATIC_DRAW);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<size_t>(this->_EBOdata->size) * this->_EBOdata->stride, nullptr, GL_STATIC_DRAW);
 	}
 	glBindVertexArray(0);
 }
 
+void ScopGL::_receiveChunks( void ) {
+	SCOP_ZONE("ScopGL::_receiveChunks");
+	// a time budget, not a number of chunks: a big mesh takes a few frames on a fast machine and the frame rate holds on a slow one
+	auto start = std::chrono::steady_clock::now();
+	do {
+		std::optional<MeshChunk> chunk = this->_chunks.tryPop();
+		if (!chunk)
+			break;
+		else if (chunk->preview) {
+			this->_uploadPreview(*chunk->preview);
+			continue;
+		}
+		if (!this->_VBOdata) {
+			this->_VBOdata = chunk->vbo;
+			this->_EBOdata = chunk->ebo;
+			this->_materials = *chunk->materials;
+			this->_loadMaterials();
+			this->_loadBuffersInGPU();
+		}
+		this->_uploadChunk(*chunk);
+	} while (std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count() < SCOP_STREAM_FRAME_BUDGET_MS);
+
+	// the preview is replaced by the whole mesh at once, not by its pieces
+	if (this->_previewVAO and this->_isMeshUploaded())
+		this->_deletePreview();
+
+	if (this->_loader.joinable() and this->_loadingDone.load(std::memory_order_acquire) and this->_chunks.empty()) {
+		this->_loader.join();
+		if (this->_loadingError)
+			std::rethrow_exception(this->_loadingError);
+		std::cout << "mesh uploaded to GPU" << std::endl;
+	}
+}
+
+void ScopGL::_uploadChunk( MeshChunk const& chunk ) {
+	SCOP_ZONE("ScopGL::_uploadChunk");
+	glBindBuffer(GL_ARRAY_BUFFER, this->_VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, static_cast<size_t>(chunk.firstVertex) * this->_VBOdata->stride,
+		static_cast<size_t>(chunk.nVertexes) * this->_VBOdata->stride, this->_VBOdata->getData() + static_cast<size_t>(chunk.firstVertex) * this->_VBOdata->stride);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	this->_uploadedVertexes = chunk.firstVertex + chunk.nVertexes;
+	if (this->_EBOdata) {
+		// the EBO binding is part of the VAO
+		glBindVertexArray(this->_VAO);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<size_t>(chunk.firstIndex) * this->_EBOdata->stride,
+			static_cast<size_t>(chunk.nIndexes) * this->_EBOdata->stride, this->_EBOdata->getData() + static_cast<size_t>(chunk.firstIndex) * this->_EBOdata->stride);
+		glBindVertexArray(0);
+		this->_uploadedIndexes = chunk.firstIndex + chunk.nIndexes;
+	}
+}
+
+void ScopGL::_uploadPreview( PreviewBlock const& block ) {
+	SCOP_ZONE("ScopGL::_uploadPreview");
+	if (!this->_previewVAO)
+		glGenVertexArrays(1, &this->_previewVAO);
+	glBindVertexArray(this->_previewVAO);
+	this->_appendToBuffer(GL_ARRAY_BUFFER, this->_previewBuffers[0], this->_previewCapacities[0], static_cast<size_t>(this->_previewVertexes) * sizeof(PreviewVertex),
+		block.vertexes.data(), block.vertexes.size() * sizeof(PreviewVertex));
+	// the buffer may be a new one: the attributes are set again. no uvs nor normals, drawn with the vertex colors
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PreviewVertex), (void*)offsetof(PreviewVertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PreviewVertex), (void*)offsetof(PreviewVertex, color));
+	glEnableVertexAttribArray(3);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// the EBO binding is part of the VAO
+	this->_appendToBuffer(GL_ELEMENT_ARRAY_BUFFER, this->_previewBuffers[1], this->_previewCapacities[1], static_cast<size_t>(this->_previewIndexes) * sizeof(uint32_t),
+		block.indexes.data(), block.indexes.size() * sizeof(uint32_t));
+	glBindVertexArray(0);
+	this->_previewVertexes += static_cast<uint32_t>(block.vertexes.size());
+	this->_previewIndexes += static_cast<uint32_t>(block.indexes.size());
+}
+
+void ScopGL::_appendToBuffer( GLenum target, GLuint& buffer, size_t& capacity, size_t used, void const* data, size_t size ) {
+	// the size of the file isn't known while it's parsed: a full buffer is replaced by one twice as big,
+	// its content copied by the GPU
+	if (used + size > capacity) {
+		size_t newCapacity = std::max(used + size, capacity * 2);
+		GLuint newBuffer = 0U;
+		glGenBuffers(1, &newBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, newCapacity, nullptr, GL_STATIC_DRAW);
+		if (used > 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		if (buffer)
+			glDeleteBuffers(1, &buffer);
+		buffer = newBuffer;
+		capacity = newCapacity;
+	}
+	glBindBuffer(target, buffer);
+	if (size > 0)
+		glBufferSubData(target, used, size, data);
+}
+
+uint32_t ScopGL::_drawPreview( void ) {
+	glBindVertexArray(this->_previewVAO);
+	glBindTexture(GL_TEXTURE_2D, this->_texture);
+	glUniform1i(this->_materialUniforms.useMaterial, GL_FALSE);
+	glUniform1f(this->_blendingUniform, 0.0f);
+	glDrawElements(GL_TRIANGLES, this->_previewIndexes, GL_UNSIGNED_INT, nullptr);
+	glBindVertexArray(this->_VAO);
+	return 1U;
+}
+
+void ScopGL::_deletePreview( void ) {
+	if (this->_previewVAO)
+		glDeleteVertexArrays(1, &this->_previewVAO);
+	for (GLuint& buffer : this->_previewBuffers) {
+		if (buffer)
+			glDeleteBuffers(1, &buffer);
+		buffer = 0U;
+	}
+	this->_previewVAO = 0U;
+	this->_previewCapacities = {0U, 0U};
+	this->_previewVertexes = 0U;
+	this->_previewIndexes = 0U;
+}
+
+bool ScopGL::_isMeshUploaded( void ) const noexcept {
+	return this->_VBOdata and this->_uploadedVertexes == this->_VBOdata->size and
+		(!this->_EBOdata or this->_uploadedIndexes == this->_EBOdata->size);
+}
+
+void ScopGL::_loadFile( std::string fileName, uint32_t threads, bool useCache, bool optimize, bool packVertexes ) noexcept {
+	SCOP_THREAD_NAME("loader");
+	try {
+		SCOP_ZONE("ScopGL::_loadFile");
+		std::shared_ptr<VBO> vboData;
+		std::shared_ptr<EBO> eboData;
+		std::shared_ptr<std::vector<Material>> materials = std::make_shared<std::vector<Material>>();
+		auto start = std::chrono::steady_clock::now();
+		// stdin has no file to stat: the cache couldn't tell if it's stale
+		useCache = useCache and fileName != "-";
+		MeshCache cache(fileName, (optimize ? CACHE_OPTIMIZED : 0U) | (packVertexes ? CACHE_PACKED : 0U));
+		if (useCache and cache.load(vboData, eboData, *materials)) {
+			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+			std::cout << "loaded mesh cache " << cache.getCacheFile().string() << " in " << elapsed.count() << "ms" << std::endl;
+			this->_streamChunks(vboData, eboData, materials);
+		} else {
+			ThreadPool pool(threads);
+			FileParser parser;
+			// the window shows the faces of every block while the next ones are parsed
+			uint32_t previewVertexes = 0U;
+			parser.setProgress([this, &previewVertexes]( ParsedData const& parsed, size_t firstFace ) {
+				this->_streamPreview(parsed, firstFace, previewVertexes);
+			});
+			ParsedData data = parser.parse(fileName, pool);
+
+			data.triangolate(pool);
+			data.fixTrianglesOrientation(pool);
+			data.fillTexturesAndNormals(pool);
+			data.loadMaterials();
+			auto startBuffers = std::chrono::steady_clock::now();
+			data.fillBuffers();
+			auto elapsedBuffers = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startBuffers);
+			if (optimize and data.hasFaces()) {
+				auto [acmrBefore, acmrAfter] = data.optimizeBuffers();
+				std::cout << "vertex cache optimized, ACMR: " << acmrBefore << " -> " << acmrAfter << std::endl;
+			}
+			data.compactBuffers(packVertexes);
+			vboData = data.getVBO();
+			if (data.hasFaces())
+				eboData = data.getEBO();
+			*materials = data.getMaterials();
+			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+			std::cout << "parsed file " << fileName << " in " << elapsed.count() << "ms (";
+			if (parser.getFormat() == MeshFormat::OBJ)
+				std::cout << threads << " threads, " << LineScanner::levelToString(LineScanner::detectLevel()) << " scanner)" << std::endl;
+			else
+				std::cout << "binary " << meshFormatToString(parser.getFormat()) << ")" << std::endl;
+			if (parser.getCompression() != Compression::NONE) {
+				float ratio = static_cast<float>(parser.getInputBytes()) / static_cast<float>(std::max<uint64_t>(parser.getReadBytes(), 1U));
+				std::cout << "decompressed " << parser.getReadBytes() << " -> " << parser.getInputBytes() << " bytes (" << ratio << "x)" << std::endl;
+			}
+			if (eboData) {
+				float ratio = static_cast<float>(eboData->size) / static_cast<float>(std::max(vboData->size, 1U));
+				std::cout << "dedup: " << eboData->size << " corners -> " << vboData->size << " vertexes (" << ratio << "x) in " << elapsedBuffers.count() / 1000.0f << "ms" << std::endl;
+			}
+			size_t eboBytes = eboData ? static_cast<size_t>(eboData->size) * eboData->stride : 0U;
+			std::cout << "GPU buffers: " << static_cast<size_t>(vboData->size) * vboData->stride + eboBytes << " bytes (" << vboData->stride << " bytes per vertex";
+			if (eboData)
+				std::cout << ", " << eboData->stride * 8 << " bits indexes";
+			std::cout << ")" << std::endl;
+			if (eboData)
+				std::cout << "materials: " << materials->size() - 1 << " loaded, " << eboData->ranges.size() << " draw calls" << std::endl;
+			MemoryStats memory = getMemoryStats();
+			std::cout << "memory: " << memory.allocations << " allocations (" << memory.allocatedBytes / 1000000 << "MB), peak RSS " << memory.peakRss / 1000000 << "MB" << std::endl;
+			// the render thread starts drawing while the cache is written
+			this->_streamChunks(vboData, eboData, materials);
+			if (useCache)
+				cache.save(*vboData, eboData.get(), *materials, data.getTmlFiles());
+		}
+	} catch (...) {
+		this->_loadingError = std::current_exception();
+	}
+	this->_loadingDone.store(true, std::memory_order_release);
+}
+
+void ScopGL::_streamChunks( std::shared_ptr<VBO> const& vboData, std::shared_ptr<EBO> const& eboData, std::shared_ptr<std::vector<Material>> const& materials ) {
+	SCOP_ZONE("ScopGL::_streamChunks");
+	// vertexes are in order of first use: the vertexes of a chunk of triangles follow the ones of the previous chunks
+	uint32_t const chunkIndexes = SCOP_STREAM_CHUNK_TRIANGLES * 3;
+	uint32_t vertexEnd = 0U;
+	uint32_t nIndexes = eboData ? eboData->size : vboData->size;
+	for (uint32_t first=0; first<nIndexes and this->_stopLoading == false; first+=chunkIndexes) {
+		MeshChunk chunk{vboData, eboData, materials, vertexEnd, 0U, first, std::min(chunkIndexes, nIndexes - first), nullptr};
+		if (eboData) {
+			for (uint32_t i=first; i<first + chunk.nIndexes; i++)
+				vertexEnd = std::max(vertexEnd, eboData->getIndex(i) + 1);
+		} else
+			vertexEnd = first + chunk.nIndexes;
+		if (first + chunk.nIndexes == nIndexes)
+			vertexEnd = vboData->size;
+		chunk.nVertexes = vertexEnd - chunk.firstVertex;
+		if (!eboData)
+			chunk.nIndexes = 0U;
+		if (this->_pushChunk(std::move(chunk)) == false)
+			return;
+	}
+}
+
+void ScopGL::_streamPreview( ParsedData const& data, size_t firstFace, uint32_t& sentVertexes ) {
+	SCOP_ZONE("ScopGL::_streamPreview");
+	if (this->_stopLoading)
+		return;
+	std::vector<VectF3> const& vertexes = data.getVertices();
+	FaceStore const& faces = data.getFaces();
+	std::shared_ptr<PreviewBlock> block = std::make_shared<PreviewBlock>();
+	block->vertexes.reserve(vertexes.size() - sentVertexes);
+	for (size_t i=sentVertexes; i<vertexes.size(); i++)
+		block->vertexes.push_back(PreviewVertex{vertexes[i], previewColor(i)});
+	for (size_t i=firstFace; i<faces.size(); i++) {
+		VectUI3 const* corners = faces.getCorners(i);
+		uint32_t nCorners = faces.getCornersCount(i);
+		// a vertex not parsed yet (or out of range): the face waits for the final mesh
+		bool parsed = true;
+		for (uint32_t j=0; j<nCorners and parsed; j++)
+			parsed = corners[j].i1 < vertexes.size();
+		if (parsed == false)
+			continue;
+		for (uint32_t j=1; j + 1<nCorners; j++) {
+			block->indexes.push_back(corners[0].i1);
+			block->indexes.push_back(corners[j].i1);
+			block->indexes.push_back(corners[j + 1].i1);
+		}
+	}
+	sentVertexes = static_cast<uint32_t>(vertexes.size());
+	if (block->vertexes.empty() and block->indexes.empty())
+		return;
+	MeshChunk chunk;
+	chunk.preview = std::move(block);
+	this->_pushChunk(std::move(chunk));
+}
+
+bool ScopGL::_pushChunk( MeshChunk&& chunk ) {
+	// the queue is full when the render thread is behind
+	while (this->_chunks.tryPush(std::move(chunk)) == false) {
+		if (this->_stopLoading)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
 void ScopGL::_moveCamera( void ) {
 	if (!this->_camera)
 		throw AppException("OpenGL not running, call .loop()");
-	else if (glfwGetWindowAttrib(this->_window, GLFW_FOCUSED) == false)
-		return;
 
-	static float lastFrame = 0.0f;
+	// also while unfocused: the time away isn't a step when the focus is back
 	float currentFrame = glfwGetTime();
-	float deltaTime = currentFrame - lastFrame;
-	lastFrame = currentFrame;
+	float deltaTime = currentFrame - this->_lastFrameTime;
+	this->_lastFrameTime = currentFrame;
+	if (glfwGetWindowAttrib(this->_window, GLFW_FOCUSED) == false)
+		return;
 
 	if (glfwGetKey(this->_window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS or
 		glfwGetKey(this->_window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS)
@@ -592,3 +1221,56 @@ void ScopGL::_rotateCamera( float posX, float posY ) {
 	this->_currCursorX = posX;
 	this->_currCursorY = posY;
 }
+
+void ScopGL::_createFramebuffer( void ) {
+	glGenFramebuffers(1, &this->_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->_framebuffer);
+	glGenRenderbuffers(2, this->_renderbuffers.data());
+	glBindRenderbuffer(GL_RENDERBUFFER, this->_renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, this->_widthWindow, this->_heightWindow);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->_renderbuffers[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->_renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, this->_widthWindow, this->_heightWindow);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->_renderbuffers[1]);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		throw OpenGlException("Offscreen framebuffer incomplete");
+}
+
+void ScopGL::_waitForMesh( void ) {
+	// the uploads of the frames of loop(), without drawing
+	while (this->_loader.joinable() or this->_pendingTextures.empty() == false) {
+		this->_receiveChunks();
+		this->_receiveTextures();
+		if (this->_chunks.empty())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void ScopGL::_scriptFrame( float progress ) noexcept {
+	// the same path on every run: the model turns and nods while the camera moves in and out,
+	// colors in the first half and textures in the second one
+	float angle = 2.0f * static_cast<float>(M_PI) * progress;
+	this->_model->reset();
+	this->_model->rotate(20.0f * sinf(angle), 360.0f * SCOP_BENCH_TURNS * progress, 0.0f);
+	this->_camera->resetPosition();
+	this->_camera->moveForward(SCOP_CAMERA_DISTANCE * 0.4f * sinf(angle));
+	this->_blendingLevel = progress < 0.5f ? 0.0f : 1.0f;
+}
+
+PathFrame ScopGL::_getFrameState( double time ) const noexcept {
+	PathFrame frame;
+	frame.time = time;
+	frame.camera = this->_camera->getState();
+	std::copy_n(this->_model->getTransformation().data(), frame.model.size(), frame.model.begin());
+	frame.blending = this->_blendingLevel;
+	return frame;
+}
+
+void ScopGL::_setFrameState( PathFrame const& frame ) noexcept {
+	this->_camera->setState(frame.camera);
+	this->_model->setTransformation(Matrix4(frame.model));
+	// a fading in progress would change the recorded level
+	this->_isFading = false;
+	this->_blendingLevel = frame.blending;
+}
@@ -0,0 +1,481 @@
+#include <array>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "textureContainer.hpp"
+#include "mappedFile.hpp"
+#include "exception.hpp"
+
+
+using Pixel = std::array<uint8_t,4>;
+using Block = std::array<Pixel,16>;
+
+// DDS_HEADER and DDS_HEADER_DXT10 as uint32_t fields, after the "DDS " magic
+static constexpr uint32_t DDS_MAGIC = 0x20534444U;
+static constexpr uint32_t DDS_HEADER_SIZE = 124;
+static constexpr uint32_t DDS_DX10_SIZE = 20;
+static constexpr uint32_t DDSD_CAPS = 0x1U, DDSD_HEIGHT = 0x2U, DDSD_WIDTH = 0x4U, DDSD_PIXELFORMAT = 0x1000U;
+static constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000U, DDSD_LINEARSIZE = 0x80000U;
+static constexpr uint32_t DDPF_ALPHAPIXELS = 0x1U, DDPF_FOURCC = 0x4U, DDPF_RGB = 0x40U;
+static constexpr uint32_t DDSCAPS_COMPLEX = 0x8U, DDSCAPS_TEXTURE = 0x1000U, DDSCAPS_MIPMAP = 0x400000U;
+static constexpr uint32_t DXGI_FORMAT_R8G8B8A8_UNORM = 28, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29;
+static constexpr uint32_t DXGI_FORMAT_BC1_UNORM = 71, DXGI_FORMAT_BC1_UNORM_SRGB = 72;
+static constexpr uint32_t DXGI_FORMAT_BC3_UNORM = 77, DXGI_FORMAT_BC3_UNORM_SRGB = 78;
+static constexpr uint32_t DXGI_FORMAT_BC7_UNORM = 98, DXGI_FORMAT_BC7_UNORM_SRGB = 99;
+static constexpr uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+
+// positions of the fields in the header, in uint32_t
+enum DDSField : uint32_t {
+	DDS_SIZE = 0, DDS_FLAGS = 1, DDS_HEIGHT = 2, DDS_WIDTH = 3, DDS_LINEAR_SIZE = 4, DDS_MIPMAP_COUNT = 6,
+	DDS_PF_SIZE = 18, DDS_PF_FLAGS = 19, DDS_PF_FOURCC = 20, DDS_PF_BITCOUNT = 21,
+	DDS_PF_RMASK = 22, DDS_PF_GMASK = 23, DDS_PF_BMASK = 24, DDS_PF_AMASK = 25, DDS_CAPS = 26
+};
+
+static constexpr uint32_t fourCC( char a, char b, char c, char d ) noexcept {
+	return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+static uint16_t to565( Pixel const& pixel ) noexcept {
+	uint32_t r = (pixel[0] * 31U + 127U) / 255U;
+	uint32_t g = (pixel[1] * 63U + 127U) / 255U;
+	uint32_t b = (pixel[2] * 31U + 127U) / 255U;
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static Pixel from565( uint16_t color ) noexcept {
+	uint32_t r = (color >> 11) & 31U, g = (color >> 5) & 63U, b = color & 31U;
+	return {static_cast<uint8_t>((r << 3) | (r >> 2)), static_cast<uint8_t>((g << 2) | (g >> 4)), static_cast<uint8_t>((b << 3) | (b >> 2)), 255U};
+}
+
+static Pixel mixPixels( Pixel const& a, uint32_t weightA, Pixel const& b, uint32_t weightB ) noexcept {
+	Pixel mixed;
+	for (uint32_t c=0; c<4; c++)
+		mixed[c] = static_cast<uint8_t>((a[c] * weightA + b[c] * weightB) / (weightA + weightB));
+	return mixed;
+}
+
+static uint32_t colorDistance( Pixel const& a, Pixel const& b ) noexcept {
+	uint32_t distance = 0U;
+	for (uint32_t c=0; c<3; c++)
+		distance += (a[c] - b[c]) * (a[c] - b[c]);
+	return distance;
+}
+
+// pixels of the block at (blockX, blockY), the borders repeat on images not multiple of 4
+static Block fetchBlock( uint8_t const* pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY ) noexcept {
+	Block block;
+	for (uint32_t y=0; y<4; y++) {
+		for (uint32_t x=0; x<4; x++) {
+			uint32_t px = std::min(blockX * 4 + x, width - 1);
+			uint32_t py = std::min(blockY * 4 + y, height - 1);
+			std::memcpy(block[y * 4 + x].data(), pixels + (static_cast<size_t>(py) * width + px) * 4, 4);
+		}
+	}
+	return block;
+}
+
+static void storeBlock( Block const& block, uint8_t* pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY ) noexcept {
+	for (uint32_t y=0; y<4 and blockY * 4 + y < height; y++) {
+		for (uint32_t x=0; x<4 and blockX * 4 + x < width; x++)
+			std::memcpy(pixels + (static_cast<size_t>(blockY * 4 + y) * width + blockX * 4 + x) * 4, block[y * 4 + x].data(), 4);
+	}
+}
+
+static void encodeColorBlock( Block const& block, uint8_t* out ) noexcept {
+	// principal axis of the colors, by power iteration on their covariance
+	std::array<float,3> mean{0.0f, 0.0f, 0.0f};
+	for (Pixel const& pixel : block) {
+		for (uint32_t c=0; c<3; c++)
+			mean[c] += pixel[c] / 16.0f;
+	}
+	std::array<std::array<float,3>,3> covariance{};
+	for (Pixel const& pixel : block) {
+		for (uint32_t i=0; i<3; i++) {
+			for (uint32_t j=0; j<3; j++)
+				covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+		}
+	}
+	std::array<float,3> axis{1.0f, 1.0f, 1.0f};
+	for (uint32_t iteration=0; iteration<8; iteration++) {
+		std::array<float,3> next{0.0f, 0.0f, 0.0f};
+		for (uint32_t i=0; i<3; i++) {
+			for (uint32_t j=0; j<3; j++)
+				next[i] += covariance[i][j] * axis[j];
+		}
+		float length = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+		if (length < 1e-6f)
+			break;
+		for (uint32_t i=0; i<3; i++)
+			axis[i] = next[i] / length;
+	}
+
+	// endpoints: the colors at the ends of the axis
+	uint32_t minPixel = 0U, maxPixel = 0U;
+	float minProjection = 0.0f, maxProjection = 0.0f;
+	for (uint32_t i=0; i<16; i++) {
+		float projection = 0.0f;
+		for (uint32_t c=0; c<3; c++)
+			projection += (block[i][c] - mean[c]) * axis[c];
+		if (i == 0 or projection < minProjection) {
+			minProjection = projection;
+			minPixel = i;
+		}
+		if (i == 0 or projection > maxProjection) {
+			maxProjection = projection;
+			maxPixel = i;
+		}
+	}
+	uint16_t color0 = to565(block[maxPixel]);
+	uint16_t color1 = to565(block[minPixel]);
+	// color0 > color1: 4 colors mode
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	uint32_t indexes = 0U;
+	if (color0 != color1) {
+		Pixel p0 = from565(color0), p1 = from565(color1);
+		std::array<Pixel,4> palette{p0, p1, mixPixels(p0, 2, p1, 1), mixPixels(p0, 1, p1, 2)};
+		for (uint32_t i=0; i<16; i++) {
+			uint32_t best = 0U;
+			for (uint32_t p=1; p<4; p++) {
+				if (colorDistance(block[i], palette[p]) < colorDistance(block[i], palette[best]))
+					best = p;
+			}
+			indexes |= best << (2 * i);
+		}
+	}
+	std::memcpy(out, &color0, sizeof(uint16_t));
+	std::memcpy(out + 2, &color1, sizeof(uint16_t));
+	std::memcpy(out + 4, &indexes, sizeof(uint32_t));
+}
+
+static void encodeAlphaBlock( Block const& block, uint8_t* out ) noexcept {
+	uint8_t alpha0 = 0U, alpha1 = 255U;
+	for (Pixel const& pixel : block) {
+		alpha0 = std::max(alpha0, pixel[3]);
+		alpha1 = std::min(alpha1, pixel[3]);
+	}
+	// alpha0 > alpha1: 8 alphas mode
+	uint64_t indexes = 0U;
+	if (alpha0 != alpha1) {
+		std::array<uint32_t,8> palette{alpha0, alpha1};
+		for (uint32_t i=1; i<7; i++)
+			palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+		for (uint32_t i=0; i<16; i++) {
+			uint32_t best = 0U;
+			for (uint32_t p=1; p<8; p++) {
+				if (std::abs(static_cast<int32_t>(block[i][3]) - static_cast<int32_t>(palette[p])) <
+					std::abs(static_cast<int32_t>(block[i][3]) - static_cast<int32_t>(palette[best])))
+					best = p;
+			}
+			indexes |= static_cast<uint64_t>(best) << (3 * i);
+		}
+	}
+	out[0] = alpha0;
+	out[1] = alpha1;
+	for (uint32_t i=0; i<6; i++)
+		out[2 + i] = static_cast<uint8_t>(indexes >> (8 * i));
+}
+
+static void decodeColorBlock( uint8_t const* in, bool isBC1, Block& block ) noexcept {
+	uint16_t color0, color1;
+	uint32_t indexes;
+	std::memcpy(&color0, in, sizeof(uint16_t));
+	std::memcpy(&color1, in + 2, sizeof(uint16_t));
+	std::memcpy(&indexes, in + 4, sizeof(uint32_t));
+	Pixel p0 = from565(color0), p1 = from565(color1);
+	std::array<Pixel,4> palette{p0, p1, mixPixels(p0, 2, p1, 1), mixPixels(p0, 1, p1, 2)};
+	// BC1 with color0 <= color1: 3 colors and transparent black, BC3 colors always have 4
+	if (isBC1 and color0 <= color1) {
+		palette[2] = mixPixels(p0, 1, p1, 1);
+		palette[3] = Pixel{0U, 0U, 0U, 0U};
+	}
+	for (uint32_t i=0; i<16; i++) {
+		Pixel const& color = palette[(indexes >> (2 * i)) & 3U];
+		std::memcpy(block[i].data(), color.data(), isBC1 ? 4 : 3);
+	}
+}
+
+static void decodeAlphaBlock( uint8_t const* in, Block& block ) noexcept {
+	uint32_t alpha0 = in[0], alpha1 = in[1];
+	std::array<uint32_t,8> palette{alpha0, alpha1, 0U, 0U, 0U, 0U, 0U, 255U};
+	if (alpha0 > alpha1) {
+		for (uint32_t i=1; i<7; i++)
+			palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+	} else {
+		for (uint32_t i=1; i<5; i++)
+			palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+	}
+	uint64_t indexes = 0U;
+	for (uint32_t i=0; i<6; i++)
+		indexes |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+	for (uint32_t i=0; i<16; i++)
+		block[i][3] = static_cast<uint8_t>(palette[(indexes >> (3 * i)) & 7U]);
+}
+
+static void addLevel( Texture& texture, uint32_t width, uint32_t height ) {
+	size_t offset = texture.data.size();
+	size_t size = getLevelSize(texture.format, width, height);
+	texture.levels.push_back(TextureLevel{width, height, offset, size});
+	texture.data.resize(offset + size);
+}
+
+
+bool isCompressed( TextureFormat format ) noexcept {
+	return format != TextureFormat::RGBA8;
+}
+
+std::string formatToString( TextureFormat format ) {
+	switch (format) {
+		case TextureFormat::RGBA8:
+			return "RGBA8";
+		case TextureFormat::BC1:
+			return "BC1";
+		case TextureFormat::BC3:
+			return "BC3";
+		case TextureFormat::BC7:
+			return "BC7";
+	}
+	return "unknown";
+}
+
+size_t getLevelSize( TextureFormat format, uint32_t width, uint32_t height ) noexcept {
+	size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+	switch (format) {
+		case TextureFormat::RGBA8:
+			return static_cast<size_t>(width) * height * 4;
+		case TextureFormat::BC1:
+			return blocks * 8;
+		case TextureFormat::BC3:
+		case TextureFormat::BC7:
+			return blocks * 16;
+	}
+	return 0U;
+}
+
+bool hasAlpha( Texture const& texture ) noexcept {
+	if (texture.format != TextureFormat::RGBA8 or texture.levels.empty())
+		return false;
+	TextureLevel const& level = texture.levels[0];
+	for (size_t i=level.offset + 3; i<level.offset + level.size; i+=4) {
+		if (texture.data[i] != 255U)
+			return true;
+	}
+	return false;
+}
+
+Texture buildMipChain( uint8_t const* pixels, uint32_t width, uint32_t height ) {
+	if (width == 0 or height == 0)
+		throw AppException("Empty texture");
+	Texture texture;
+	addLevel(texture, width, height);
+	std::memcpy(texture.data.data(), pixels, texture.levels[0].size);
+
+	while (width > 1 or height > 1) {
+		uint32_t nextWidth = std::max(width / 2, 1U), nextHeight = std::max(height / 2, 1U);
+		addLevel(texture, nextWidth, nextHeight);
+		uint8_t const* source = texture.data.data() + texture.levels[texture.levels.size() - 2].offset;
+		uint8_t* destination = texture.data.data() + texture.levels.back().offset;
+		for (uint32_t y=0; y<nextHeight; y++) {
+			uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+			for (uint32_t x=0; x<nextWidth; x++) {
+				uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				for (uint32_t c=0; c<4; c++) {
+					uint32_t sum = source[(static_cast<size_t>(y0) * width + x0) * 4 + c] + source[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+						source[(static_cast<size_t>(y1) * width + x0) * 4 + c] + source[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+					destination[(static_cast<size_t>(y) * nextWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+				}
+			}
+		}
+		width = nextWidth;
+		height = nextHeight;
+	}
+	return texture;
+}
+
+Texture compressTexture( Texture const& source, TextureFormat format ) {
+	if (source.format != TextureFormat::RGBA8)
+		throw AppException("Only RGBA8 textures can be compressed");
+	else if (format != TextureFormat::BC1 and format != TextureFormat::BC3)
+		throw AppException("Texture format not supported by the encoder: " + formatToString(format));
+
+	Texture texture;
+	texture.format = format;
+	for (TextureLevel const& level : source.levels) {
+		addLevel(texture, level.width, level.height);
+		uint8_t const* pixels = source.data.data() + level.offset;
+		uint8_t* out = texture.data.data() + texture.levels.back().offset;
+		for (uint32_t blockY=0; blockY<(level.height + 3) / 4; blockY++) {
+			for (uint32_t blockX=0; blockX<(level.width + 3) / 4; blockX++) {
+				Block block = fetchBlock(pixels, level.width, level.height, blockX, blockY);
+				if (format == TextureFormat::BC3) {
+					encodeAlphaBlock(block, out);
+					out += 8;
+				}
+				encodeColorBlock(block, out);
+				out += 8;
+			}
+		}
+	}
+	return texture;
+}
+
+Texture decompressTexture( Texture const& source ) {
+	if (source.format != TextureFormat::BC1 and source.format != TextureFormat::BC3)
+		throw AppException("Texture format not supported by the decoder: " + formatToString(source.format));
+
+	Texture texture;
+	for (TextureLevel const& level : source.levels) {
+		addLevel(texture, level.width, level.height);
+		uint8_t const* in = source.data.data() + level.offset;
+		uint8_t* pixels = texture.data.data() + texture.levels.back().offset;
+		for (uint32_t blockY=0; blockY<(level.height + 3) / 4; blockY++) {
+			for (uint32_t blockX=0; blockX<(level.width + 3) / 4; blockX++) {
+				Block block;
+				block.fill(Pixel{0U, 0U, 0U, 255U});
+				if (source.format == TextureFormat::BC3) {
+					decodeAlphaBlock(in, block);
+					in += 8;
+				}
+				decodeColorBlock(in, source.format == TextureFormat::BC1, block);
+				in += 8;
+				storeBlock(block, pixels, level.width, level.height, blockX, blockY);
+			}
+		}
+	}
+	return texture;
+}
+
+Texture readDDS( std::string const& fileName ) {
+	MappedFile file(fileName);
+	std::array<uint32_t,DDS_HEADER_SIZE / 4> header;
+	uint32_t magic;
+	if (file.size() < 4 + DDS_HEADER_SIZE)
+		throw ParsingException("Invalid DDS file: " + fileName);
+	std::memcpy(&magic, file.data(), 4);
+	std::memcpy(header.data(), file.data() + 4, DDS_HEADER_SIZE);
+	if (magic != DDS_MAGIC or header[DDS_SIZE] != DDS_HEADER_SIZE or header[DDS_PF_SIZE] != 32)
+		throw ParsingException("Invalid DDS file: " + fileName);
+
+	Texture texture;
+	size_t dataOffset = 4 + DDS_HEADER_SIZE;
+	uint32_t pfFlags = header[DDS_PF_FLAGS];
+	if ((pfFlags & DDPF_FOURCC) and header[DDS_PF_FOURCC] == fourCC('D', 'X', '1', '0')) {
+		std::array<uint32_t,DDS_DX10_SIZE / 4> dx10;
+		if (file.size() < dataOffset + DDS_DX10_SIZE)
+			throw ParsingException("Invalid DDS file: " + fileName);
+		std::memcpy(dx10.data(), file.data() + dataOffset, DDS_DX10_SIZE);
+		dataOffset += DDS_DX10_SIZE;
+		if (dx10[1] != D3D10_RESOURCE_DIMENSION_TEXTURE2D or dx10[3] > 1)
+			throw ParsingException("DDS file is not a single 2D texture: " + fileName);
+		if (dx10[0] == DXGI_FORMAT_R8G8B8A8_UNORM or dx10[0] == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+			texture.format = TextureFormat::RGBA8;
+		else if (dx10[0] == DXGI_FORMAT_BC1_UNORM or dx10[0] == DXGI_FORMAT_BC1_UNORM_SRGB)
+			texture.format = TextureFormat::BC1;
+		else if (dx10[0] == DXGI_FORMAT_BC3_UNORM or dx10[0] == DXGI_FORMAT_BC3_UNORM_SRGB)
+			texture.format = TextureFormat::BC3;
+		else if (dx10[0] == DXGI_FORMAT_BC7_UNORM or dx10[0] == DXGI_FORMAT_BC7_UNORM_SRGB)
+			texture.format = TextureFormat::BC7;
+		else
+			throw ParsingException("DDS format not supported: " + fileName);
+	}
+	else if ((pfFlags & DDPF_FOURCC) and header[DDS_PF_FOURCC] == fourCC('D', 'X', 'T', '1'))
+		texture.format = TextureFormat::BC1;
+	else if ((pfFlags & DDPF_FOURCC) and header[DDS_PF_FOURCC] == fourCC('D', 'X', 'T', '5'))
+		texture.format = TextureFormat::BC3;
+	else if ((pfFlags & DDPF_RGB) and header[DDS_PF_BITCOUNT] == 32 and header[DDS_PF_RMASK] == 0x000000ffU and
+		header[DDS_PF_GMASK] == 0x0000ff00U and header[DDS_PF_BMASK] == 0x00ff0000U)
+		texture.format = TextureFormat::RGBA8;
+	else
+		throw ParsingException("DDS format not supported: " + fileName);
+
+	uint32_t width = header[DDS_WIDTH], height = header[DDS_HEIGHT];
+	uint32_t nLevels = (header[DDS_FLAGS] & DDSD_MIPMAPCOUNT) ? std::max(header[DDS_MIPMAP_COUNT], 1U) : 1U;
+	if (width == 0 or height == 0 or nLevels > 32)
+		throw ParsingException("Invalid DDS size: " + fileName);
+	// the levels are checked against the file before anything is allocated: a corrupt header can ask for any size
+	size_t available = file.size() - dataOffset, total = 0U;
+	for (uint32_t i=0, levelWidth=width, levelHeight=height; i<nLevels; i++) {
+		size_t size = getLevelSize(texture.format, levelWidth, levelHeight);
+		if (size > available - total)
+			throw ParsingException("DDS file too short: " + fileName);
+		total += size;
+		levelWidth = std::max(levelWidth / 2, 1U);
+		levelHeight = std::max(levelHeight / 2, 1U);
+	}
+	texture.data.reserve(total);
+	for (uint32_t i=0; i<nLevels; i++) {
+		addLevel(texture, width, height);
+		width = std::max(width / 2, 1U);
+		height = std::max(height / 2, 1U);
+	}
+	std::memcpy(texture.data.data(), file.data() + dataOffset, texture.data.size());
+	// RGBA without alpha mask: opaque
+	if (texture.format == TextureFormat::RGBA8 and !(pfFlags & DDPF_FOURCC) and !(pfFlags & DDPF_ALPHAPIXELS)) {
+		for (size_t i=3; i<texture.data.size(); i+=4)
+			texture.data[i] = 255U;
+	}
+	return texture;
+}
+
+void writeDDS( std::string const& fileName, Texture const& texture ) {
+	if (texture.levels.empty())
+		throw AppException("Empty texture");
+
+	std::array<uint32_t,DDS_HEADER_SIZE / 4> header{};
+	header[DDS_SIZE] = DDS_HEADER_SIZE;
+	header[DDS_FLAGS] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header[DDS_HEIGHT] = texture.levels[0].height;
+	header[DDS_WIDTH] = texture.levels[0].width;
+	header[DDS_LINEAR_SIZE] = static_cast<uint32_t>(texture.levels[0].size);
+	header[DDS_MIPMAP_COUNT] = static_cast<uint32_t>(texture.levels.size());
+	header[DDS_PF_SIZE] = 32;
+	header[DDS_CAPS] = DDSCAPS_TEXTURE | (texture.levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0U);
+	std::array<uint32_t,DDS_DX10_SIZE / 4> dx10{DXGI_FORMAT_BC7_UNORM, D3D10_RESOURCE_DIMENSION_TEXTURE2D, 0U, 1U, 0U};
+	switch (texture.format) {
+		case TextureFormat::RGBA8:
+			header[DDS_PF_FLAGS] = DDPF_RGB | DDPF_ALPHAPIXELS;
+			header[DDS_PF_BITCOUNT] = 32;
+			header[DDS_PF_RMASK] = 0x000000ffU;
+			header[DDS_PF_GMASK] = 0x0000ff00U;
+			header[DDS_PF_BMASK] = 0x00ff0000U;
+			header[DDS_PF_AMASK] = 0xff000000U;
+			break;
+		case TextureFormat::BC1:
+			header[DDS_PF_FLAGS] = DDPF_FOURCC;
+			header[DDS_PF_FOURCC] = fourCC('D', 'X', 'T', '1');
+			break;
+		case TextureFormat::BC3:
+			header[DDS_PF_FLAGS] = DDPF_FOURCC;
+			header[DDS_PF_FOURCC] = fourCC('D', 'X', 'T', '5');
+			break;
+		case TextureFormat::BC7:
+			header[DDS_PF_FLAGS] = DDPF_FOURCC;
+			header[DDS_PF_FOURCC] = fourCC('D', 'X', '1', '0');
+			break;
+	}
+
+	// written aside and renamed, like the mesh cache
+	std::string tmpFile = fileName + ".tmp";
+	{
+		std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<char const*>(&DDS_MAGIC), sizeof(uint32_t));
+		out.write(reinterpret_cast<char const*>(header.data()), DDS_HEADER_SIZE);
+		if (texture.format == TextureFormat::BC7)
+			out.write(reinterpret_cast<char const*>(dx10.data()), DDS_DX10_SIZE);
+		out.write(reinterpret_cast<char const*>(texture.data.data()), texture.data.size());
+		if (!out) {
+			std::remove(tmpFile.c_str());
+			throw AppException("Couldn't write texture: " + fileName);
+		}
+	}
+	if (std::rename(tmpFile.c_str(), fileName.c_str()) != 0) {
+		std::remove(tmpFile.c_str());
+		throw AppException("Couldn't write texture: " + fileName);
+	}
+}
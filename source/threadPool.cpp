@@ -0,0 +1,100 @@
+#include <algorithm>
+
+#include "threadPool.hpp"
+#include "profiler.hpp"
+
+
+ThreadPool::ThreadPool( uint32_t threads ) {
+	for (uint32_t i=1; i<threads; i++)
+		this->_workers.emplace_back(&ThreadPool::_work, this);
+}
+
+ThreadPool::~ThreadPool( void ) noexcept {
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_stop = true;
+	}
+	this->_wakeUp.notify_all();
+	for (std::thread& worker : this->_workers)
+		worker.join();
+}
+
+uint32_t ThreadPool::size( void ) const noexcept {
+	return static_cast<uint32_t>(this->_workers.size()) + 1U;
+}
+
+std::vector<size_t> ThreadPool::split( size_t count, size_t minSize ) const {
+	size_t nRanges = std::clamp<size_t>(count / std::max<size_t>(minSize, 1), 1, this->size());
+	std::vector<size_t> bounds(nRanges + 1);
+	for (size_t i=0; i<=nRanges; i++)
+		bounds[i] = count * i / nRanges;
+	return bounds;
+}
+
+void ThreadPool::run( size_t nTasks, std::function<void(size_t)> const& task ) {
+	if (this->_workers.empty() or nTasks == 1) {
+		for (size_t i=0; i<nTasks; i++)
+			task(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_task = &task;
+		this->_nTasks = nTasks;
+		this->_nextTask = 0U;
+		this->_doneTasks = 0U;
+		this->_errors.assign(nTasks, nullptr);
+		this->_job++;
+	}
+	this->_wakeUp.notify_all();
+	this->_runTasks();
+	{
+		// a late worker must be out of the job before the next one resets it
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_finished.wait(lock, [this]() { return this->_doneTasks == this->_nTasks and this->_activeWorkers == 0; });
+		this->_task = nullptr;
+	}
+	for (std::exception_ptr const& error : this->_errors) {
+		if (error)
+			std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::_work( void ) noexcept {
+	SCOP_THREAD_NAME("pool worker");
+	uint64_t lastJob = 0U;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(this->_mutex);
+			this->_wakeUp.wait(lock, [&]() { return this->_stop or (this->_job != lastJob and this->_task); });
+			if (this->_stop)
+				return;
+			lastJob = this->_job;
+			this->_activeWorkers++;
+		}
+		this->_runTasks();
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			this->_activeWorkers--;
+		}
+		this->_finished.notify_one();
+	}
+}
+
+void ThreadPool::_runTasks( void ) noexcept {
+	size_t done = 0U;
+	for (size_t i = this->_nextTask++; i < this->_nTasks; i = this->_nextTask++) {
+		try {
+			(*this->_task)(i);
+		} catch (...) {
+			this->_errors[i] = std::current_exception();
+		}
+		done++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_doneTasks += done;
+	}
+	this->_finished.notify_one();
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+
+#include "triangulator.hpp"
+
+// bits of the x and y coordinate inside a z-order code
+static constexpr uint32_t Z_MASK_X = 0x55555555U;
+static constexpr uint32_t Z_MASK_Y = 0xAAAAAAAAU;
+
+
+void Triangulator::triangulate( std::vector<VectF2> const& points, std::vector<Triangle>& triangles ) {
+	uint32_t nPoints = static_cast<uint32_t>(points.size());
+	if (nPoints < 3)
+		return;
+
+	this->_points = &points;
+	// the sign of the area (shoelace formula) gives the winding of the corners
+	float area = 0.0f;
+	for (uint32_t i=0; i<nPoints; i++)
+		area += points[i] ^ points[(i + 1) % nPoints];
+	this->_orientation = (area < 0.0f) ? -1.0f : 1.0f;
+
+	if (nPoints == 4)
+		this->_triangulateQuad(triangles);
+	else if (this->_isConvexPolygon()) {
+		// fan around the last corner
+		for (uint32_t i=0; i + 3 < nPoints; i++)
+			triangles.push_back(Triangle{nPoints - 1, i, i + 1});
+		triangles.push_back(Triangle{nPoints - 3, nPoints - 2, nPoints - 1});
+	}
+	else
+		this->_clipEars(triangles);
+}
+
+void Triangulator::_triangulateQuad( std::vector<Triangle>& triangles ) const noexcept {
+	// cut the first convex corner whose triangle doesn't contain the opposite corner,
+	// for a convex quad it's always the first one: a fan around the last corner;
+	// straight corners (of degenerate quads too) aren't cut, like reflex ones
+	std::vector<VectF2> const& points = *this->_points;
+	uint32_t ear = 0;
+	for (uint32_t i=0; i<4; i++) {
+		VectF2 const& prev = points[(i + 3) % 4];
+		VectF2 const& next = points[(i + 1) % 4];
+		if (((points[i] - prev) ^ (next - points[i])) * this->_orientation < 0.0f or !(width(prev, points[i], next) < M_PI))
+			continue;
+		if (triangleContainmentTest(prev, points[i], next, points[(i + 2) % 4]) == false) {
+			ear = i;
+			break;
+		}
+	}
+	triangles.push_back(Triangle{(ear + 3) % 4, ear, (ear + 1) % 4});
+
+	// the corners left, in polygon order
+	Triangle last;
+	for (uint32_t i=0, j=0; i<4; i++) {
+		if (i != ear)
+			last[j++] = i;
+	}
+	triangles.push_back(last);
+}
+
+bool Triangulator::_isConvexPolygon( void ) const noexcept {
+	// every corner has to turn the same way and the edges can change x and y direction
+	// only twice, otherwise it's a star polygon that winds more than once
+	std::vector<VectF2> const& points = *this->_points;
+	uint32_t nPoints = static_cast<uint32_t>(points.size());
+	int32_t firstX = 0, firstY = 0, lastX = 0, lastY = 0;
+	uint32_t flipsX = 0, flipsY = 0;
+
+	for (uint32_t i=0; i<nPoints; i++) {
+		VectF2 edgeIn = points[i] - points[(i + nPoints - 1) % nPoints];
+		VectF2 edgeOut = points[(i + 1) % nPoints] - points[i];
+		if ((edgeIn ^ edgeOut) * this->_orientation < 0.0f)
+			return false;
+
+		int32_t signX = (edgeOut.x > 0.0f) - (edgeOut.x < 0.0f);
+		int32_t signY = (edgeOut.y > 0.0f) - (edgeOut.y < 0.0f);
+		if (signX != 0) {
+			if (firstX == 0)
+				firstX = signX;
+			else if (signX != lastX)
+				flipsX++;
+			lastX = signX;
+		}
+		if (signY != 0) {
+			if (firstY == 0)
+				firstY = signY;
+			else if (signY != lastY)
+				flipsY++;
+			lastY = signY;
+		}
+	}
+	// closing the loop
+	flipsX += (lastX != firstX);
+	flipsY += (lastY != firstY);
+	return flipsX <= 2 and flipsY <= 2;
+}
+
+void Triangulator::_clipEars( std::vector<Triangle>& triangles ) {
+	std::vector<VectF2> const& points = *this->_points;
+	uint32_t nPoints = static_cast<uint32_t>(points.size());
+
+	// buffers are kept between polygons, only resized
+	this->_prev.resize(nPoints);
+	this->_next.resize(nPoints);
+	this->_reflex.assign(nPoints, 0);
+	this->_reflexByZ.clear();
+	this->_remaining = nPoints;
+
+	this->_min = points[0];
+	VectF2 max = points[0];
+	for (uint32_t i=0; i<nPoints; i++) {
+		this->_prev[i] = (i + nPoints - 1) % nPoints;
+		this->_next[i] = (i + 1) % nPoints;
+		this->_min = VectF2{std::min(this->_min.x, points[i].x), std::min(this->_min.y, points[i].y)};
+		max = VectF2{std::max(max.x, points[i].x), std::max(max.y, points[i].y)};
+	}
+	float size = std::max(max.x - this->_min.x, max.y - this->_min.y);
+	this->_scale = (size > 0.0f) ? 65535.0f / size : 0.0f;
+
+	for (uint32_t i=0; i<nPoints; i++) {
+		if (this->_isConvex(i) == false) {
+			this->_reflex[i] = 1;
+			this->_reflexByZ.emplace_back(this->_zOrder(points[i]), i);
+		}
+	}
+	std::sort(this->_reflexByZ.begin(), this->_reflexByZ.end());
+
+	// walk the ring, after a clip the next corner is skipped: it avoids cutting a fan of slivers
+	uint32_t curr = 0;
+	uint32_t stop = 0;
+	while (this->_remaining > 3) {
+		if (this->_isConvex(curr) and this->_isEar(curr)) {
+			uint32_t prev = this->_prev[curr];
+			uint32_t next = this->_next[curr];
+			this->_clip(curr, triangles);
+			// only the two neighbours change, a reflex one can turn convex
+			for (uint32_t neighbour : {prev, next}) {
+				if (this->_reflex[neighbour] and this->_isConvex(neighbour))
+					this->_reflex[neighbour] = 0;
+			}
+			curr = this->_next[next];
+			stop = curr;
+			continue;
+		}
+		curr = this->_next[curr];
+		// nothing clipped in a whole lap: degenerate or self-intersecting polygon
+		if (curr == stop)
+			break;
+	}
+
+	// the last 3 corners (or what is left of a degenerate polygon) are split as a fan
+	for (uint32_t corner = this->_next[curr]; this->_next[corner] != curr; corner = this->_next[corner])
+		triangles.push_back(Triangle{curr, corner, this->_next[corner]});
+}
+
+bool Triangulator::_isConvex( uint32_t corner ) const noexcept {
+	// aligned corners count as convex: clipping them leaves an empty triangle
+	std::vector<VectF2> const& points = *this->_points;
+	VectF2 edgeIn = points[corner] - points[this->_prev[corner]];
+	VectF2 edgeOut = points[this->_next[corner]] - points[corner];
+	return (edgeIn ^ edgeOut) * this->_orientation >= 0.0f;
+}
+
+bool Triangulator::_isEar( uint32_t corner ) const noexcept {
+	// a convex corner is an ear if no reflex corner lies inside its triangle,
+	// only the reflex corners with z-order code in the range of the triangle bounding box can
+	std::vector<VectF2> const& points = *this->_points;
+	uint32_t prev = this->_prev[corner];
+	uint32_t next = this->_next[corner];
+	VectF2 const& a = points[prev];
+	VectF2 const& b = points[corner];
+	VectF2 const& c = points[next];
+	VectF2 min{std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y})};
+	VectF2 max{std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y})};
+	uint32_t minZ = this->_zOrder(min);
+	uint32_t maxZ = this->_zOrder(max);
+
+	auto it = std::lower_bound(this->_reflexByZ.cbegin(), this->_reflexByZ.cend(), std::make_pair(minZ, 0U));
+	while (it != this->_reflexByZ.cend() and it->first <= maxZ) {
+		uint32_t code = it->first;
+		// codes in the range can be outside the box, jump to the first one back inside
+		if ((code & Z_MASK_X) < (minZ & Z_MASK_X) or (code & Z_MASK_X) > (maxZ & Z_MASK_X) or
+			(code & Z_MASK_Y) < (minZ & Z_MASK_Y) or (code & Z_MASK_Y) > (maxZ & Z_MASK_Y)) {
+			it = std::lower_bound(it, this->_reflexByZ.cend(), std::make_pair(this->_nextZInBox(code, minZ, maxZ), 0U));
+			continue;
+		}
+		uint32_t check = (it++)->second;
+		if (this->_reflex[check] == 0 or check == prev or check == next)
+			continue;
+		VectF2 const& point = points[check];
+		if (point.x < min.x or point.x > max.x or point.y < min.y or point.y > max.y)
+			continue;
+		if (triangleContainmentTest(a, b, c, point) == true)
+			return false;
+	}
+	return true;
+}
+
+void Triangulator::_clip( uint32_t corner, std::vector<Triangle>& triangles ) noexcept {
+	uint32_t prev = this->_prev[corner];
+	uint32_t next = this->_next[corner];
+	triangles.push_back(Triangle{prev, corner, next});
+	this->_next[prev] = next;
+	this->_prev[next] = prev;
+	this->_remaining--;
+}
+
+uint32_t Triangulator::_zOrder( VectF2 const& point ) const noexcept {
+	// coordinates scaled to 16 bits inside the polygon bounding box, then bits interleaved (Morton code)
+	uint32_t x = static_cast<uint32_t>(std::clamp((point.x - this->_min.x) * this->_scale, 0.0f, 65535.0f));
+	uint32_t y = static_cast<uint32_t>(std::clamp((point.y - this->_min.y) * this->_scale, 0.0f, 65535.0f));
+
+	x = (x | (x << 8)) & 0x00FF00FF;
+	x = (x | (x << 4)) & 0x0F0F0F0F;
+	x = (x | (x << 2)) & 0x33333333;
+	x = (x | (x << 1)) & 0x55555555;
+	y = (y | (y << 8)) & 0x00FF00FF;
+	y = (y | (y << 4)) & 0x0F0F0F0F;
+	y = (y | (y << 2)) & 0x33333333;
+	y = (y | (y << 1)) & 0x55555555;
+	return x | (y << 1);
+}
+
+uint32_t Triangulator::_nextZInBox( uint32_t code, uint32_t minZ, uint32_t maxZ ) const noexcept {
+	// BIGMIN: smallest code bigger than 'code' inside the box [minZ, maxZ], walking the bits from the top
+	// reference: Tropf, Herzog - Multidimensional Range Search in Dynamically Balanced Trees (1981)
+	uint32_t bigMin = maxZ;
+	for (int32_t bit=31; bit>=0; bit--) {
+		uint32_t mask = 1U << bit;
+		// lower bits of the same coordinate
+		uint32_t lower = ((bit % 2 == 0) ? Z_MASK_X : Z_MASK_Y) & (mask - 1);
+		uint32_t loadMin = (minZ | mask) & ~lower;		// bit set, lower bits cleared
+		uint32_t loadMax = (maxZ & ~mask) | lower;		// bit cleared, lower bits set
+
+		switch (((code & mask) ? 4 : 0) | ((minZ & mask) ? 2 : 0) | ((maxZ & mask) ? 1 : 0)) {
+			case 0b001:
+				bigMin = loadMin;
+				maxZ = loadMax;
+				break;
+			case 0b011:
+				return minZ;
+			case 0b100:
+				return bigMin;
+			case 0b101:
+				minZ = loadMin;
+				break;
+			default:	// the other cases keep the box as it is
+				break;
+		}
+	}
+	return bigMin;
+}
@@ -0,0 +1,39 @@
+#include <cstring>
+
+#include "vertexTable.hpp"
+
+
+VertexTable::VertexTable( size_t nCorners, float const* vbo, uint32_t vertexSize ) : _vbo(vbo), _vertexSize(vertexSize) {
+	size_t capacity = 16;
+	while (capacity < nCorners * 2)
+		capacity <<= 1;
+	this->_slots.assign(capacity, std::pair<uint32_t,uint32_t>{0U, 0U});
+	this->_mask = capacity - 1;
+}
+
+std::pair<uint32_t,bool> VertexTable::insert( SerializedVertex const& vertex, uint32_t newIndex ) {
+	uint32_t hash = this->_hash(vertex);
+	for (size_t slot = hash & this->_mask; ; slot = (slot + 1) & this->_mask) {
+		auto& [slotHash, slotIndex] = this->_slots[slot];
+		if (slotIndex == 0) {
+			slotHash = hash;
+			slotIndex = newIndex + 1;
+			return {newIndex, true};
+		}
+		uint32_t index = slotIndex - 1;
+		if (slotHash == hash and std::memcmp(this->_vbo + static_cast<size_t>(index) * this->_vertexSize, vertex.data(), vertex.size()) == 0)
+			return {index, false};
+	}
+}
+
+uint32_t VertexTable::_hash( SerializedVertex const& vertex ) const noexcept {
+	// 8 bytes at a time, multiply and fold (64 bits golden ratio constant)
+	uint64_t hash = 0U;
+	for (size_t i=0; i<vertex.size(); i+=sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, vertex.data() + i, sizeof(uint64_t));
+		hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+		hash ^= hash >> 29;
+	}
+	return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
@@ -0,0 +1,257 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <filesystem>
+#include <optional>
+
+#include "parser.hpp"
+#include "data.hpp"
+#include "threadPool.hpp"
+#include "exception.hpp"
+#include "math/matrix.hpp"
+#include "math/quaternion.hpp"
+#include "math/utilities.hpp"
+
+
+namespace fs = std::filesystem;
+
+// loading steps on the object files given and on generated ones, then the math kernels of the render loop;
+// one json object per result (times of a repetition in milliseconds), the lines of two runs can be diffed
+static constexpr char const* USAGE = "usage: scop_bench [--threads n] [--repetitions n] [file.obj...]";
+static constexpr uint32_t REPETITIONS = 21;
+// quads per side of the generated grid, points of the generated star polygons
+static constexpr uint32_t GRID_SIZE = 256;
+static constexpr uint32_t STAR_POLYGONS = 8192;
+static constexpr uint32_t STAR_POINTS = 16;
+// matrices and quaternions of the math kernels, run MATH_ROUNDS times per repetition
+static constexpr size_t MATH_COUNT = 1024;
+static constexpr uint32_t MATH_ROUNDS = 256;
+
+struct BenchResult {
+	std::string			name;
+	std::string			input;
+	std::string			unit;		// of the throughput: items per second
+	double				items;		// per repetition
+	std::vector<double>	times;		// milliseconds
+};
+
+struct BenchOptions {
+	uint32_t					threads = 1U;
+	uint32_t					repetitions = REPETITIONS;
+	std::vector<std::string>	files;
+};
+
+static BenchOptions parseOptions( int32_t argc, char** argv ) {
+	BenchOptions options;
+	for (int32_t i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "--threads" or arg == "--repetitions") and i + 1 < argc) {
+			int32_t value = std::atoi(argv[++i]);
+			if (value < 1)
+				throw ParsingException("Wrong value for " + arg + ": " + argv[i]);
+			(arg == "--threads" ? options.threads : options.repetitions) = static_cast<uint32_t>(value);
+		} else if (arg.rfind("--", 0) == 0)
+			throw ParsingException(USAGE);
+		else
+			options.files.push_back(arg);
+	}
+	return options;
+}
+
+template <typename Function>
+static double timeMs( Function const& function ) {
+	auto start = std::chrono::steady_clock::now();
+	function();
+	return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// nearest rank of the sorted times
+static double percentile( std::vector<double> times, double rank ) {
+	std::sort(times.begin(), times.end());
+	size_t index = static_cast<size_t>(std::ceil(rank * times.size()));
+	return times[std::clamp<size_t>(index, 1, times.size()) - 1];
+}
+
+// grid of quads with uvs, no normals: fillTexturesAndNormals computes them
+static void writeGrid( fs::path const& file ) {
+	std::ofstream obj(file);
+	for (uint32_t y=0; y<=GRID_SIZE; y++) {
+		for (uint32_t x=0; x<=GRID_SIZE; x++) {
+			float u = static_cast<float>(x) / GRID_SIZE, v = static_cast<float>(y) / GRID_SIZE;
+			obj << "v " << u * 2.0f - 1.0f << " " << std::sin(u * 6.28318f) * 0.1f << " " << v * 2.0f - 1.0f << "\nvt " << u << " " << v << "\n";
+		}
+	}
+	for (uint32_t y=0; y<GRID_SIZE; y++) {
+		for (uint32_t x=0; x<GRID_SIZE; x++) {
+			uint32_t first = y * (GRID_SIZE + 1) + x + 1;
+			uint32_t corners[4] = {first, first + 1, first + GRID_SIZE + 2, first + GRID_SIZE + 1};
+			obj << "f";
+			for (uint32_t corner : corners)
+				obj << " " << corner << "/" << corner;
+			obj << "\n";
+		}
+	}
+	if (!obj)
+		throw ParsingException("Couldn't write generated file: " + file.string());
+}
+
+// concave polygons: every other point is pulled to the center, the triangulator clips ears instead of a fan
+static void writeStars( fs::path const& file ) {
+	std::ofstream obj(file);
+	for (uint32_t i=0; i<STAR_POLYGONS; i++) {
+		float centerX = static_cast<float>(i % 128) * 2.5f, centerY = static_cast<float>(i / 128) * 2.5f;
+		for (uint32_t j=0; j<STAR_POINTS; j++) {
+			float angle = 6.28318f * j / STAR_POINTS, radius = j % 2 ? 0.5f : 1.0f;
+			obj << "v " << centerX + std::cos(angle) * radius << " " << centerY + std::sin(angle) * radius << " 0\n";
+		}
+	}
+	for (uint32_t i=0; i<STAR_POLYGONS; i++) {
+		obj << "f";
+		for (uint32_t j=0; j<STAR_POINTS; j++)
+			obj << " " << i * STAR_POINTS + j + 1;
+		obj << "\n";
+	}
+	if (!obj)
+		throw ParsingException("Couldn't write generated file: " + file.string());
+}
+
+// every repetition runs the steps in order on a fresh parse, loadMaterials isn't timed
+static void benchmarkFile( std::string const& fileName, std::string const& input, BenchOptions const& options, std::vector<BenchResult>& results ) {
+	BenchResult parse{"FileParser::parse", input, "bytes/s", 0.0, {}};
+	BenchResult triangolate{"ParsedData::triangolate", input, "faces/s", 0.0, {}};
+	BenchResult orientation{"ParsedData::fixTrianglesOrientation", input, "triangles/s", 0.0, {}};
+	BenchResult normals{"ParsedData::fillTexturesAndNormals", input, "triangles/s", 0.0, {}};
+	BenchResult buffers{"ParsedData::fillBuffers", input, "corners/s", 0.0, {}};
+	ThreadPool pool(options.threads);
+	std::streambuf* errors = std::cerr.rdbuf();
+
+	for (uint32_t i=0; i<options.repetitions; i++) {
+		FileParser parser;
+		std::optional<ParsedData> parsed;
+		parse.times.push_back(timeMs([&]() { parsed.emplace(parser.parse(fileName, pool)); }));
+		parse.items = static_cast<double>(parser.getInputBytes());
+		ParsedData& data = *parsed;
+		triangolate.items = static_cast<double>(data.getFaces().size());
+		triangolate.times.push_back(timeMs([&]() { data.triangolate(pool); }));
+		orientation.items = normals.items = static_cast<double>(data.getFaces().size());
+		orientation.times.push_back(timeMs([&]() { data.fixTrianglesOrientation(pool); }));
+		normals.times.push_back(timeMs([&]() { data.fillTexturesAndNormals(pool); }));
+		// a missing material library is reported once, not at every repetition
+		if (i > 0)
+			std::cerr.rdbuf(nullptr);
+		data.loadMaterials();
+		std::cerr.rdbuf(errors);
+		std::cerr.clear();
+		buffers.times.push_back(timeMs([&]() { data.fillBuffers(); }));
+		buffers.items = static_cast<double>(data.hasFaces() ? data.getEBO()->size : data.getVBO()->size);
+	}
+	for (BenchResult* result : {&parse, &triangolate, &orientation, &normals, &buffers})
+		results.push_back(std::move(*result));
+}
+
+static void benchmarkMath( BenchOptions const& options, std::vector<BenchResult>& results ) {
+	std::vector<Matrix4> matrices;
+	std::vector<Quatern> rotations;
+	for (size_t i=0; i<MATH_COUNT; i++) {
+		// unit axes and rigid transforms: the chained products stay finite
+		VectF3 axis{randomFloat() + 0.1f, randomFloat(), randomFloat()};
+		axis = axis / getAbs(axis);
+		float angle = toRadiants(randomFloat() * 360.0f);
+		matrices.push_back(rotationMat(angle, axis) * transMat(VectF3{randomFloat(), randomFloat(), randomFloat()}));
+		rotations.push_back(Quatern(angle / 2.0f, axis));
+	}
+	double const items = static_cast<double>(MATH_COUNT) * MATH_ROUNDS;
+	volatile float sink = 0.0f;
+	BenchResult multiply{"Matrix4 multiply", "generated", "ops/s", items, {}};
+	BenchResult product{"Quatern multiply", "generated", "ops/s", items, {}};
+	BenchResult toMatrix{"Quatern::getMatrix", "generated", "ops/s", items, {}};
+	BenchResult rotate{"Quatern rotate vector", "generated", "ops/s", items, {}};
+
+	for (uint32_t i=0; i<options.repetitions; i++) {
+		// chained, as the model matrix of every frame: a result is the input of the next one
+		multiply.times.push_back(timeMs([&]() {
+			float sum = 0.0f;
+			for (uint32_t round=0; round<MATH_ROUNDS; round++) {
+				Matrix4 result = idMat();
+				for (Matrix4 const& matrix : matrices)
+					result = result * matrix;
+				sum += result.data()[round % 16];
+			}
+			sink = sum;
+		}));
+		product.times.push_back(timeMs([&]() {
+			Quatern result(1.0f, 0.0f, 0.0f, 0.0f);
+			for (uint32_t round=0; round<MATH_ROUNDS; round++) {
+				for (Quatern const& rotation : rotations)
+					result *= rotation;
+				result = result / getAbs(result);
+			}
+			sink = result.w;
+		}));
+		toMatrix.times.push_back(timeMs([&]() {
+			float sum = 0.0f;
+			for (uint32_t round=0; round<MATH_ROUNDS; round++) {
+				for (Quatern const& rotation : rotations)
+					sum += rotation.getMatrix().data()[round % 16];
+			}
+			sink = sum;
+		}));
+		rotate.times.push_back(timeMs([&]() {
+			Quatern vector(0.0f, 1.0f, 0.0f, 0.0f);
+			for (uint32_t round=0; round<MATH_ROUNDS; round++) {
+				for (Quatern const& rotation : rotations)
+					vector = rotation * vector * rotation.conjugate();
+			}
+			sink = vector.x;
+		}));
+	}
+	for (BenchResult* result : {&multiply, &product, &toMatrix, &rotate})
+		results.push_back(std::move(*result));
+}
+
+static void printResults( std::vector<BenchResult> const& results, BenchOptions const& options ) {
+	std::cout << std::fixed << "{\"repetitions\":" << options.repetitions << ",\"threads\":" << options.threads << ",\"results\":[";
+	for (size_t i=0; i<results.size(); i++) {
+		BenchResult const& result = results[i];
+		double median = percentile(result.times, 0.5), p95 = percentile(result.times, 0.95);
+		std::cout << (i > 0 ? ",\n" : "\n") << std::setprecision(3) << "{\"name\":\"" << result.name << "\",\"input\":\"" << result.input <<
+			"\",\"items\":" << std::setprecision(0) << result.items << ",\"median_ms\":" << std::setprecision(3) << median <<
+			",\"p95_ms\":" << p95 << ",\"throughput\":" << std::setprecision(0) << (median > 0.0 ? result.items / median * 1000.0 : 0.0) <<
+			",\"unit\":\"" << result.unit << "\"}";
+	}
+	std::cout << "\n]}" << std::endl;
+}
+
+int32_t main( int32_t argc, char** argv ) {
+	fs::path directory;
+	try {
+		BenchOptions options = parseOptions(argc, argv);
+		std::vector<BenchResult> results;
+		for (std::string const& file : options.files)
+			benchmarkFile(file, fs::path(file).filename().string(), options, results);
+
+		directory = fs::temp_directory_path() / ("scop_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+		fs::create_directories(directory);
+		writeGrid(directory / "grid.obj");
+		writeStars(directory / "stars.obj");
+		benchmarkFile((directory / "grid.obj").string(), "generated grid", options, results);
+		benchmarkFile((directory / "stars.obj").string(), "generated stars", options, results);
+		fs::remove_all(directory);
+
+		benchmarkMath(options, results);
+		printResults(results, options);
+	} catch (std::exception const& err) {
+		// filesystem errors of the generated files too
+		std::cerr << err.what() << std::endl;
+		std::error_code error;
+		if (directory.empty() == false)
+			fs::remove_all(directory, error);
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
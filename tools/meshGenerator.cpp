@@ -0,0 +1,413 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <memory>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "exception.hpp"
+
+
+namespace fs = std::filesystem;
+
+// object files of any size for the scaling tests: a grid of vertexes on a wave, with triangles, quads and concave
+// n-gons laid on its cells; the same options and seed always give the same file
+static constexpr char const* USAGE = R"(usage: scop_meshgen [options] <file.obj | ->
+	--faces n            faces written (default 1M), n can end with k, M or G
+	--vertices n         vertexes of the grid, rounded up to full rows (default: half the faces)
+	--mix t,q,n          weights of triangles, quads and n-gons among the faces (default 6,3,1)
+	--ngon n             corners of the n-gons, even and at least 6 (default 64): concave zigzag bands
+	--textures           vt of every vertex
+	--normals            vn of every vertex
+	--objects n          o switches, the faces are split in n runs (default 1)
+	--groups n           g switches (default 0)
+	--smoothing n        s switches (default 0)
+	--materials n        materials written to <file>.mtl and used in turn (default 0)
+	--material-runs n    usemtl switches, the n materials are cycled (default: as many as the materials)
+	--seed n             of the face types and of the material colors (default 42))";
+// bytes written to the file at a time
+static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+// waves of the grid along x: the height only depends on x and its slope stays below 1,
+// the projection of a band on its plane keeps the shape simple
+static constexpr float WAVE_HEIGHT = 0.05f;
+static constexpr float WAVE_FREQUENCY = 6.0f;
+
+struct GeneratorOptions {
+	std::string				outputFile;
+	uint64_t				faces = 1000000U;
+	uint64_t				vertexes = 0U;		// 0: half the faces
+	std::array<uint32_t,3>	mix{6U, 3U, 1U};
+	uint32_t				ngonCorners = 64U;
+	bool					textures = false;
+	bool					normals = false;
+	uint64_t				objects = 1U;
+	uint64_t				groups = 0U;
+	uint64_t				smoothing = 0U;
+	uint64_t				materials = 0U;
+	uint64_t				materialRuns = 0U;	// 0: as many as the materials
+	uint64_t				seed = 42U;
+};
+
+enum FaceKind : uint8_t {
+	TRIANGLE,
+	QUAD,
+	NGON
+};
+
+// buffered writer of the text, numbers formatted without the locale of the streams
+class ObjWriter {
+	public:
+		explicit ObjWriter( std::string const& fileName ) : _buffer(new char[WRITE_BUFFER_SIZE]) {
+			this->_file = fileName == "-" ? stdout : std::fopen(fileName.c_str(), "wb");
+			if (!this->_file)
+				throw ParsingException("Error while opening file: " + fileName);
+		}
+		ObjWriter( ObjWriter const& ) = delete;
+		ObjWriter& operator=( ObjWriter const& ) = delete;
+		~ObjWriter( void ) noexcept {
+			if (this->_file and this->_file != stdout)
+				std::fclose(this->_file);
+		}
+
+		void	text( std::string_view text ) {
+			if (this->_used + text.size() > WRITE_BUFFER_SIZE)
+				this->flush();
+			std::memcpy(this->_buffer.get() + this->_used, text.data(), text.size());
+			this->_used += text.size();
+		}
+		void	number( uint64_t value ) {
+			this->_reserve();
+			this->_used = std::to_chars(this->_buffer.get() + this->_used, this->_buffer.get() + WRITE_BUFFER_SIZE, value).ptr - this->_buffer.get();
+		}
+		void	number( float value ) {
+			this->_reserve();
+			this->_used = std::to_chars(this->_buffer.get() + this->_used, this->_buffer.get() + WRITE_BUFFER_SIZE, value,
+				std::chars_format::fixed, 6).ptr - this->_buffer.get();
+		}
+		void	flush( void ) {
+			if (std::fwrite(this->_buffer.get(), 1, this->_used, this->_file) != this->_used)
+				throw ParsingException("Error while writing the object file");
+			this->_written += this->_used;
+			this->_used = 0U;
+		}
+		void	close( void ) {
+			this->flush();
+			if (std::fflush(this->_file) != 0)
+				throw ParsingException("Error while writing the object file");
+		}
+		uint64_t	getWritten( void ) const noexcept {
+			return this->_written;
+		}
+
+	private:
+		// longest number: a fixed float of a big coordinate
+		void	_reserve( void ) {
+			if (this->_used + 64 > WRITE_BUFFER_SIZE)
+				this->flush();
+		}
+
+		std::FILE*				_file = nullptr;
+		std::unique_ptr<char[]>	_buffer;
+		size_t					_used = 0U;
+		uint64_t				_written = 0U;
+};
+
+// xorshift64*: the same sequence on every platform, std distributions aren't
+class Random {
+	public:
+		explicit Random( uint64_t seed ) noexcept : _state(seed ? seed : 1U) {}
+
+		uint64_t	next( void ) noexcept {
+			this->_state ^= this->_state >> 12;
+			this->_state ^= this->_state << 25;
+			this->_state ^= this->_state >> 27;
+			return this->_state * 2685821657736338717ULL;
+		}
+		float		nextFloat( void ) noexcept {
+			return static_cast<float>(this->next() >> 40) / static_cast<float>(1U << 24);
+		}
+
+	private:
+		uint64_t	_state;
+};
+
+// 1000, 10k, 100M, 1G
+static uint64_t parseCount( std::string const& option, std::string_view value ) {
+	uint64_t multiplier = 1U;
+	if (value.empty() == false) {
+		char suffix = value.back();
+		multiplier = suffix == 'k' ? 1000U : suffix == 'M' ? 1000000U : suffix == 'G' ? 1000000000U : 1U;
+		if (multiplier > 1U)
+			value.remove_suffix(1);
+	}
+	uint64_t count = 0U;
+	auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+	if (error != std::errc() or end != value.data() + value.size() or value.empty())
+		throw ParsingException("Wrong number for " + option + ": " + std::string(value));
+	return count * multiplier;
+}
+
+static GeneratorOptions parseOptions( int32_t argc, char** argv ) {
+	GeneratorOptions options;
+	for (int32_t i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--textures")
+			options.textures = true;
+		else if (arg == "--normals")
+			options.normals = true;
+		else if (arg.rfind("--", 0) == 0 and i + 1 < argc) {
+			std::string_view value = argv[++i];
+			if (arg == "--faces")
+				options.faces = parseCount(arg, value);
+			else if (arg == "--vertices")
+				options.vertexes = parseCount(arg, value);
+			else if (arg == "--ngon")
+				options.ngonCorners = static_cast<uint32_t>(std::min<uint64_t>(parseCount(arg, value), UINT32_MAX));
+			else if (arg == "--objects")
+				options.objects = parseCount(arg, value);
+			else if (arg == "--groups")
+				options.groups = parseCount(arg, value);
+			else if (arg == "--smoothing")
+				options.smoothing = parseCount(arg, value);
+			else if (arg == "--materials")
+				options.materials = parseCount(arg, value);
+			else if (arg == "--material-runs")
+				options.materialRuns = parseCount(arg, value);
+			else if (arg == "--seed")
+				options.seed = parseCount(arg, value);
+			else if (arg == "--mix") {
+				for (uint32_t& weight : options.mix) {
+					if (value.empty())
+						throw ParsingException("--mix needs 3 weights, not all 0: t,q,n");
+					size_t comma = std::min(value.find(','), value.size());
+					weight = static_cast<uint32_t>(std::min<uint64_t>(parseCount(arg, value.substr(0, comma)), UINT16_MAX));
+					value.remove_prefix(std::min(comma + 1, value.size()));
+				}
+				if (value.empty() == false or options.mix[0] + options.mix[1] + options.mix[2] == 0)
+					throw ParsingException("--mix needs 3 weights, not all 0: t,q,n");
+			}
+			else
+				throw ParsingException(USAGE);
+		}
+		else if (options.outputFile.empty() and (arg == "-" or arg.rfind("-", 0) != 0))
+			options.outputFile = arg;
+		else
+			throw ParsingException(USAGE);
+	}
+	if (options.outputFile.empty() or options.faces == 0)
+		throw ParsingException(USAGE);
+	else if (options.ngonCorners < 6 or options.ngonCorners % 2 != 0)
+		throw ParsingException("--ngon has to be even and at least 6");
+	if (options.materialRuns == 0)
+		options.materialRuns = options.materials;
+	return options;
+}
+
+class MeshGenerator {
+	public:
+		explicit MeshGenerator( GeneratorOptions const& options ) : _options(options), _random(options.seed) {
+			// an n-gon band is ngon / 2 points wide and 3 cells high
+			uint64_t vertexes = options.vertexes ? options.vertexes : std::max<uint64_t>(options.faces / 2, 1U);
+			this->_bandWidth = options.ngonCorners / 2 - 1;
+			this->_columns = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(std::sqrt(static_cast<double>(vertexes)))), this->_bandWidth + 2);
+			this->_rows = std::max<uint64_t>((vertexes + this->_columns - 1) / this->_columns, 5U);
+			// indexes of the object files are read as 32 bits
+			if (this->_columns * this->_rows >= UINT32_MAX)
+				throw ParsingException("Too many vertexes: " + std::to_string(this->_columns * this->_rows));
+			this->_step = 2.0f / static_cast<float>(std::max(this->_columns, this->_rows) - 1);
+		}
+
+		void	write( void ) {
+			auto start = std::chrono::steady_clock::now();
+			ObjWriter obj(this->_options.outputFile);
+			obj.text("# scop_meshgen\n");
+			if (this->_options.materials > 0 and this->_options.outputFile != "-") {
+				fs::path library = fs::path(this->_options.outputFile).replace_extension(".mtl");
+				this->_writeMaterials(library);
+				obj.text("mtllib ");
+				obj.text(library.filename().string());
+				obj.text("\n");
+			}
+			this->_writeVertexes(obj);
+			this->_writeFaces(obj);
+			obj.close();
+
+			double elapsed = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count();
+			// stdout may be the object file
+			std::cerr << "scop_meshgen: " << this->_options.outputFile << ": " << this->_columns * this->_rows << " vertexes, " <<
+				this->_options.faces << " faces (" << this->_counts[TRIANGLE] << " triangles, " << this->_counts[QUAD] << " quads, " <<
+				this->_counts[NGON] << " " << this->_options.ngonCorners << "-gons), " << this->_triangles << " triangles once triangulated, " <<
+				obj.getWritten() / 1000000 << "MB in " << static_cast<uint64_t>(elapsed) << "ms" << std::endl;
+		}
+
+	private:
+		void	_writeMaterials( fs::path const& library ) {
+			std::ofstream mtl(library);
+			for (uint64_t i=0; i<this->_options.materials; i++) {
+				mtl << "newmtl material_" << i << "\nNs 50\nKa 0.1 0.1 0.1\nKd " << this->_random.nextFloat() << " " <<
+					this->_random.nextFloat() << " " << this->_random.nextFloat() << "\nKs 0.5 0.5 0.5\n\n";
+			}
+			if (!mtl)
+				throw ParsingException("Error while writing material library: " + library.string());
+		}
+
+		void	_writeVertexes( ObjWriter& obj ) const {
+			for (uint64_t row=0; row<this->_rows; row++) {
+				for (uint64_t column=0; column<this->_columns; column++) {
+					float x = static_cast<float>(column) * this->_step - 1.0f;
+					obj.text("v ");
+					obj.number(x);
+					obj.text(" ");
+					obj.number(static_cast<float>(row) * this->_step - 1.0f);
+					obj.text(" ");
+					obj.number(WAVE_HEIGHT * std::sin(x * WAVE_FREQUENCY));
+					obj.text("\n");
+				}
+			}
+			if (this->_options.textures) {
+				for (uint64_t row=0; row<this->_rows; row++) {
+					for (uint64_t column=0; column<this->_columns; column++) {
+						obj.text("vt ");
+						obj.number(static_cast<float>(column) / static_cast<float>(this->_columns - 1));
+						obj.text(" ");
+						obj.number(static_cast<float>(row) / static_cast<float>(this->_rows - 1));
+						obj.text("\n");
+					}
+				}
+			}
+			if (this->_options.normals) {
+				for (uint64_t row=0; row<this->_rows; row++) {
+					for (uint64_t column=0; column<this->_columns; column++) {
+						float x = static_cast<float>(column) * this->_step - 1.0f;
+						float slope = WAVE_HEIGHT * WAVE_FREQUENCY * std::cos(x * WAVE_FREQUENCY);
+						float length = std::sqrt(slope * slope + 1.0f);
+						obj.text("vn ");
+						obj.number(-slope / length);
+						obj.text(" 0.000000 ");
+						obj.number(1.0f / length);
+						obj.text("\n");
+					}
+				}
+			}
+		}
+
+		void	_writeFaces( ObjWriter& obj ) {
+			uint64_t const faces = this->_options.faces;
+			uint32_t const totalWeight = this->_options.mix[0] + this->_options.mix[1] + this->_options.mix[2];
+			std::vector<uint64_t> corners(this->_options.ngonCorners);
+			uint64_t material = 0U;
+			for (uint64_t i=0; i<faces; i++) {
+				if (this->_isRunStart(i, this->_options.objects))
+					this->_writeSwitch(obj, "o object_", i * this->_options.objects / faces);
+				if (this->_isRunStart(i, this->_options.groups))
+					this->_writeSwitch(obj, "g group_", i * this->_options.groups / faces);
+				if (this->_options.materials > 0 and this->_isRunStart(i, this->_options.materialRuns))
+					this->_writeSwitch(obj, "usemtl material_", material++ % this->_options.materials);
+				if (this->_isRunStart(i, this->_options.smoothing))
+					this->_writeSwitch(obj, "s ", i * this->_options.smoothing / faces + 1);
+
+				uint32_t pick = static_cast<uint32_t>(this->_random.next() % totalWeight);
+				FaceKind kind = pick < this->_options.mix[0] ? TRIANGLE : pick < this->_options.mix[0] + this->_options.mix[1] ? QUAD : NGON;
+				size_t nCorners = this->_placeFace(kind, corners);
+				this->_counts[kind]++;
+				this->_triangles += nCorners - 2;
+				obj.text("f");
+				for (size_t j=0; j<nCorners; j++)
+					this->_writeCorner(obj, corners[j]);
+				obj.text("\n");
+			}
+		}
+
+		// the faces go through the cells in order, wrapping around when the grid is full
+		size_t	_placeFace( FaceKind kind, std::vector<uint64_t>& corners ) {
+			uint64_t width = kind == NGON ? this->_bandWidth : 1U, height = kind == NGON ? 3U : 1U;
+			uint64_t cell = this->_nextCell;
+			this->_nextCell += width;
+			uint64_t column = cell % (this->_columns - width);
+			uint64_t row = (cell / (this->_columns - width)) % (this->_rows - height);
+			uint64_t first = row * this->_columns + column + 1;
+			uint64_t up = this->_columns;
+			if (kind == QUAD) {
+				corners[0] = first;
+				corners[1] = first + 1;
+				corners[2] = first + up + 1;
+				corners[3] = first + up;
+				return 4U;
+			}
+			else if (kind == TRIANGLE) {
+				// the two halves of the cells in turn
+				bool lower = (this->_counts[TRIANGLE] & 1U) == 0;
+				corners[0] = first;
+				corners[1] = lower ? first + 1 : first + up + 1;
+				corners[2] = lower ? first + up + 1 : first + up;
+				return 3U;
+			}
+			// zigzag bottom from left to right, zigzag top back: counterclockwise, no 3 points aligned
+			size_t n = 0U;
+			for (uint64_t x=0; x<=width; x++)
+				corners[n++] = first + (x % 2) * up + x;
+			for (uint64_t x=width + 1; x-- > 0;)
+				corners[n++] = first + (2 + x % 2) * up + x;
+			return n;
+		}
+
+		bool	_isRunStart( uint64_t face, uint64_t runs ) const noexcept {
+			if (runs == 0)
+				return false;
+			else if (face == 0)
+				return true;
+			return face * runs / this->_options.faces != (face - 1) * runs / this->_options.faces;
+		}
+
+		void	_writeSwitch( ObjWriter& obj, std::string_view directive, uint64_t value ) const {
+			obj.text(directive);
+			obj.number(value);
+			obj.text("\n");
+		}
+
+		// v, v/vt, v//vn or v/vt/vn: every vertex has its own uv and normal
+		void	_writeCorner( ObjWriter& obj, uint64_t index ) const {
+			obj.text(" ");
+			obj.number(index);
+			if (this->_options.textures or this->_options.normals) {
+				obj.text("/");
+				if (this->_options.textures)
+					obj.number(index);
+				if (this->_options.normals) {
+					obj.text("/");
+					obj.number(index);
+				}
+			}
+		}
+
+		GeneratorOptions const&	_options;
+		Random					_random;
+		uint64_t				_columns;
+		uint64_t				_rows;
+		uint64_t				_bandWidth;
+		float					_step;
+		uint64_t				_nextCell = 0U;
+		std::array<uint64_t,3>	_counts{};
+		uint64_t				_triangles = 0U;
+};
+
+int32_t main( int32_t argc, char** argv ) {
+	try {
+		GeneratorOptions options = parseOptions(argc, argv);
+		MeshGenerator generator(options);
+		generator.write();
+	} catch (std::exception const& err) {
+		// filesystem errors of the material library too
+		std::cerr << err.what() << std::endl;
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
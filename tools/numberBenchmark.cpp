@@ -0,0 +1,123 @@
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <charconv>
+
+#include "numberParser.hpp"
+#include "mappedFile.hpp"
+#include "exception.hpp"
+
+
+// numbers of the object files read by the fast paths against std::from_chars and the split on '/' used before
+static constexpr char const* USAGE = "usage: scop_numbench <file.obj>...";
+static constexpr uint32_t REPETITIONS = 21;
+
+template <typename Function>
+static double medianNs( Function const& function, size_t count ) {
+	std::vector<double> times;
+	for (uint32_t i=0; i<REPETITIONS; i++) {
+		auto start = std::chrono::steady_clock::now();
+		function();
+		times.push_back(std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now() - start).count() / count);
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+static void benchmarkFile( std::string const& fileName ) {
+	MappedFile file(fileName);
+	std::vector<std::string_view> floats, corners;
+	std::string_view buffer = file.view();
+	while (buffer.empty() == false) {
+		size_t endLine = buffer.find('\n');
+		std::string_view line = buffer.substr(0, endLine);
+		buffer.remove_prefix(endLine == std::string_view::npos ? buffer.size() : endLine + 1);
+		bool isFace = line.rfind("f ", 0) == 0;
+		if (isFace == false and line.rfind("v ", 0) != 0 and line.rfind("vt ", 0) != 0 and line.rfind("vn ", 0) != 0)
+			continue;
+		line.remove_prefix(line.find(' '));
+		while (line.empty() == false) {
+			size_t start = line.find_first_not_of(" \t\r");
+			if (start == std::string_view::npos)
+				break;
+			size_t end = std::min(line.find_first_of(" \t\r", start), line.size());
+			(isFace ? corners : floats).push_back(line.substr(start, end - start));
+			line.remove_prefix(end);
+		}
+	}
+
+	size_t mismatches = 0;
+	for (std::string_view number : floats) {
+		float expected = 0.0f, parsed = 0.0f;
+		std::from_chars(number.data(), number.data() + number.size(), expected);
+		parseFloat(number.data(), number.data() + number.size(), parsed);
+		mismatches += std::memcmp(&expected, &parsed, sizeof(float)) != 0;
+	}
+
+	volatile float floatSink = 0.0f;
+	volatile int64_t indexSink = 0;
+	double fromChars = medianNs([&]() {
+		float sum = 0.0f;
+		for (std::string_view number : floats) {
+			float value = 0.0f;
+			std::from_chars(number.data(), number.data() + number.size(), value);
+			sum += value;
+		}
+		floatSink = sum;
+	}, floats.size());
+	double fastPath = medianNs([&]() {
+		float sum = 0.0f;
+		for (std::string_view number : floats) {
+			float value = 0.0f;
+			parseFloat(number.data(), number.data() + number.size(), value);
+			sum += value;
+		}
+		floatSink = sum;
+	}, floats.size());
+	double split = medianNs([&]() {
+		int64_t sum = 0;
+		for (std::string_view corner : corners) {
+			while (corner.empty() == false) {
+				size_t slashPos = corner.find('/');
+				std::string_view number = corner.substr(0, slashPos);
+				corner.remove_prefix(slashPos == std::string_view::npos ? corner.size() : slashPos + 1);
+				uint32_t value = 0U;
+				std::from_chars(number.data(), number.data() + number.size(), value);
+				sum += value;
+			}
+		}
+		indexSink = sum;
+	}, corners.size());
+	double singleScan = medianNs([&]() {
+		int64_t sum = 0;
+		for (std::string_view corner : corners) {
+			FaceCorner parsed;
+			parseFaceCorner(corner, parsed);
+			sum += parsed.values[0] + parsed.values[1] + parsed.values[2];
+		}
+		indexSink = sum;
+	}, corners.size());
+
+	std::cout << fileName << ": " << floats.size() << " floats, from_chars " << fromChars << " ns, fast path " << fastPath <<
+		" ns (" << mismatches << " mismatches); " << corners.size() << " face corners, split " << split << " ns, single scan " <<
+		singleScan << " ns" << std::endl;
+}
+
+int32_t main( int32_t argc, char** argv ) {
+	if (argc < 2) {
+		std::cerr << USAGE << std::endl;
+		return (EXIT_FAILURE);
+	}
+	try {
+		for (int32_t i=1; i<argc; i++)
+			benchmarkFile(argv[i]);
+	} catch (AppException const& err) {
+		std::cerr << err.what() << std::endl;
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+
+#include "textureContainer.hpp"
+#include "exception.hpp"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+
+namespace fs = std::filesystem;
+
+// converts jpg/png textures to DDS with the full mip chain, next to the source: scop loads the .dds instead
+// when it isn't older than the image
+static constexpr char const* USAGE = "usage: scop_texconv [--format auto|bc1|bc3|rgba8] <image>...\n"
+	"  auto: BC3 if the image has transparent pixels, BC1 otherwise";
+
+struct ImageDeleter {
+	void operator()( unsigned char* pixels ) const noexcept {
+		stbi_image_free(pixels);
+	}
+};
+
+static void convertImage( fs::path const& image, std::string const& format ) {
+	auto start = std::chrono::steady_clock::now();
+	int32_t width, height, channels;
+	// bottom-up like the textures uploaded by scop
+	stbi_set_flip_vertically_on_load(true);
+	std::unique_ptr<unsigned char[],ImageDeleter> pixels(stbi_load(image.c_str(), &width, &height, &channels, 4));
+	if (!pixels)
+		throw AppException("Failed to load texture in: " + image.string());
+
+	Texture texture = buildMipChain(pixels.get(), static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	size_t uncompressedSize = texture.data.size();
+	if (format == "bc1" or (format == "auto" and hasAlpha(texture) == false))
+		texture = compressTexture(texture, TextureFormat::BC1);
+	else if (format == "bc3" or format == "auto")
+		texture = compressTexture(texture, TextureFormat::BC3);
+
+	fs::path output = image;
+	output.replace_extension(".dds");
+	writeDDS(output.string(), texture);
+	std::chrono::duration<double,std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << output.string() << ": " << width << "x" << height << " " << formatToString(texture.format) << ", " <<
+		texture.levels.size() << " mips, " << uncompressedSize / 1024 << " KB as RGBA8 -> " << texture.data.size() / 1024 <<
+		" KB in " << elapsed.count() << " ms" << std::endl;
+}
+
+int32_t main( int32_t argc, char** argv ) {
+	std::string format = "auto";
+	std::vector<fs::path> images;
+	for (int32_t i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--format" and i + 1 < argc)
+			format = argv[++i];
+		else if (arg.rfind("--format=", 0) == 0)
+			format = arg.substr(9);
+		else if (arg == "--help" or arg == "-h") {
+			std::cout << USAGE << std::endl;
+			return (EXIT_SUCCESS);
+		}
+		else
+			images.push_back(arg);
+	}
+	if (images.empty() or (format != "auto" and format != "bc1" and format != "bc3" and format != "rgba8")) {
+		std::cerr << USAGE << std::endl;
+		return (EXIT_FAILURE);
+	}
+
+	int32_t status = EXIT_SUCCESS;
+	for (fs::path const& image : images) {
+		try {
+			convertImage(image, format);
+		} catch (std::exception const& err) {
+			std::cerr << err.what() << std::endl;
+			status = EXIT_FAILURE;
+		}
+	}
+	return (status);
+}